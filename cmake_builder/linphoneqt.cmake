@@ -25,6 +25,7 @@ lcb_external_source_paths("..")
 lcb_dependencies("linphone" "ms2plugins")
 lcb_groupable(YES)
 lcb_cmake_options("-DENABLE_UPDATE_CHECK=${ENABLE_UPDATE_CHECK}")
+lcb_cmake_options("-DENABLE_BENCHMARKS=${ENABLE_BENCHMARKS}")
 
 # Add config step for packaging
 set(LINPHONE_BUILDER_ADDITIONAL_CONFIG_STEPS "${CMAKE_CURRENT_LIST_DIR}/additional_steps.cmake")
@@ -206,6 +206,15 @@ void App::initContentApp () {
   );
 }
 
+void App::initHeadlessContentApp (const QString &configPath) {
+  Q_ASSERT(!mEngine);
+
+  CoreManager::init(this, configPath);
+
+  // Models need an engine to give the ownership of their objects.
+  mEngine = new QQmlApplicationEngine();
+}
+
 // -----------------------------------------------------------------------------
 
 QString App::getCommandArgument () {
@@ -351,6 +360,7 @@ void App::registerTypes () {
   registerType<ConferenceHelperModel>("ConferenceHelperModel");
   registerType<ConferenceModel>("ConferenceModel");
   registerType<ContactsListProxyModel>("ContactsListProxyModel");
+  registerType<MessageSearchModel>("MessageSearchModel");
   registerType<SipAddressesProxyModel>("SipAddressesProxyModel");
   registerType<SoundPlayer>("SoundPlayer");
   registerType<TelephoneNumbersModel>("TelephoneNumbersModel");
@@ -367,7 +377,7 @@ void App::registerTypes () {
   registerUncreatableType(CallModel, "CallModel");
   registerUncreatableType(ConferenceHelperModel::ConferenceAddModel, "ConferenceAddModel");
   registerUncreatableType(ContactModel, "ContactModel");
-  registerUncreatableType(SipAddressObserver, "SipAddressObserver");
+  registerUncreatableType(SipAddressObserverHandle, "SipAddressObserverHandle");
   registerUncreatableType(VcardModel, "VcardModel");
 }
 
@@ -381,6 +391,7 @@ void App::registerSharedTypes () {
   registerSharedSingletonType(SipAddressesModel, "SipAddressesModel", CoreManager::getInstance()->getSipAddressesModel);
   registerSharedSingletonType(CallsListModel, "CallsListModel", CoreManager::getInstance()->getCallsListModel);
   registerSharedSingletonType(ContactsListModel, "ContactsListModel", CoreManager::getInstance()->getContactsListModel);
+  registerSharedSingletonType(DownloadManager, "DownloadManager", CoreManager::getInstance()->getDownloadManager);
 }
 
 void App::registerToolTypes () {
@@ -52,6 +52,10 @@ public:
 
   void initContentApp ();
 
+  // Init the linphone core and an engine without any view.
+  // Used by `linphone-bench`.
+  void initHeadlessContentApp (const QString &configPath);
+
   QString getCommandArgument ();
   void executeCommand (const QString &command);
 
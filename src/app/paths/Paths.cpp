@@ -46,6 +46,8 @@
 #define PATH_ROOT_CA "/linphone/rootca.pem"
 #define PATH_FRIENDS_LIST "/friends.db"
 #define PATH_MESSAGE_HISTORY_LIST "/message-history.db"
+#define PATH_MESSAGE_SEARCH_INDEX "/message-search.idx"
+#define PATH_SIP_ADDRESSES_INDEX "/sip-addresses.idx"
 #define PATH_ZRTP_SECRETS "/zidcache"
 
 using namespace std;
@@ -203,6 +205,10 @@ string Paths::getMessageHistoryFilePath () {
   return ::getWritableFilePath(::getAppMessageHistoryFilePath());
 }
 
+string Paths::getMessageSearchIndexFilePath () {
+  return ::getWritableFilePath(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + PATH_MESSAGE_SEARCH_INDEX);
+}
+
 string Paths::getPackageDataDirPath () {
   return ::getReadableDirPath(::getAppPackageDataDirPath());
 }
@@ -215,6 +221,10 @@ string Paths::getRootCaFilePath () {
   return ::getReadableFilePath(::getAppRootCaFilePath());
 }
 
+string Paths::getSipAddressesIndexFilePath () {
+  return ::getWritableFilePath(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + PATH_SIP_ADDRESSES_INDEX);
+}
+
 string Paths::getThumbnailsDirPath () {
   return ::getWritableDirPath(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + PATH_THUMBNAILS);
 }
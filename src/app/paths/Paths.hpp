@@ -42,9 +42,11 @@ namespace Paths {
   std::string getDownloadDirPath ();
   std::string getLogsDirPath ();
   std::string getMessageHistoryFilePath ();
+  std::string getMessageSearchIndexFilePath ();
   std::string getPackageDataDirPath ();
   std::string getPackageMsPluginsDirPath ();
   std::string getRootCaFilePath ();
+  std::string getSipAddressesIndexFilePath ();
   std::string getThumbnailsDirPath ();
   std::string getUserCertificatesDirPath ();
   std::string getZrtpDataFilePath ();
@@ -20,22 +20,147 @@
  *      Author: Ronan Abhamon
  */
 
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QtDebug>
+
 #include "../../utils/Utils.hpp"
 #include "../paths/Paths.hpp"
 
 #include "AvatarProvider.hpp"
 
+// Avatars are saved in squares of 64, 128 and 256 pixels.
+#define AVATAR_MIN_SIZE 64
+#define AVATAR_MAX_SIZE 256
+
+// In kilobytes. About 250 avatars of 128 pixels.
+#define AVATARS_CACHE_MAX_COST 16384
+
 // =============================================================================
 
 const QString AvatarProvider::PROVIDER_ID = "avatar";
 
+// The file of the max size is the file of the vcard, the others have a size suffix.
+inline QString getAvatarFilePath (const QString &avatarsPath, const QString &fileId, int size) {
+  if (size == AVATAR_MAX_SIZE)
+    return avatarsPath + fileId;
+
+  QFileInfo info(fileId);
+  return QStringLiteral("%1%2-%3.%4").arg(avatarsPath).arg(info.completeBaseName()).arg(size).arg(info.suffix());
+}
+
+// -----------------------------------------------------------------------------
+
 AvatarProvider::AvatarProvider () : QQuickImageProvider(
     QQmlImageProviderBase::Image,
     QQmlImageProviderBase::ForceAsynchronousImageLoading
   ) {
   mAvatarsPath = ::Utils::coreStringToAppString(Paths::getAvatarsDirPath());
+  mImages.setMaxCost(AVATARS_CACHE_MAX_COST);
+}
+
+QImage AvatarProvider::requestImage (const QString &id, QSize *size, const QSize &requestedSize) {
+  int avatarSize = AVATAR_MAX_SIZE;
+
+  const int requestedMaxSize = qMax(requestedSize.width(), requestedSize.height());
+  if (requestedMaxSize > 0) {
+    avatarSize = AVATAR_MIN_SIZE;
+    while (avatarSize < requestedMaxSize && avatarSize < AVATAR_MAX_SIZE)
+      avatarSize *= 2;
+  }
+
+  // Each set of an avatar uses a new id, the cached images are never outdated.
+  const QString key = QStringLiteral("%1/%2").arg(avatarSize).arg(id);
+  QImage image;
+
+  {
+    QMutexLocker locker(&mImagesMutex);
+    QImage *cachedImage = mImages.object(key);
+    if (cachedImage)
+      image = *cachedImage;
+  }
+
+  if (image.isNull()) {
+    image = loadImage(id, avatarSize);
+
+    if (!image.isNull()) {
+      QMutexLocker locker(&mImagesMutex);
+      mImages.insert(key, new QImage(image), qMax(1, image.byteCount() / 1024));
+    }
+  }
+
+  if (size)
+    *size = image.size();
+
+  return image;
+}
+
+// -----------------------------------------------------------------------------
+
+QImage AvatarProvider::loadImage (const QString &id, int size) const {
+  QImageReader reader(::getAvatarFilePath(mAvatarsPath, id, size));
+
+  // Avatar saved before the normalization: only the original file exists.
+  if (!reader.canRead())
+    reader.setFileName(mAvatarsPath + id);
+
+  // Large images are decoded at the requested size.
+  const QSize sourceSize = reader.size();
+  if (sourceSize.width() > size && sourceSize.height() > size)
+    reader.setScaledSize(sourceSize.scaled(size, size, Qt::KeepAspectRatioByExpanding));
+
+  QImage image = reader.read();
+  if (image.isNull())
+    qWarning() << QStringLiteral("Unable to read avatar: `%1`. (%2)").arg(id).arg(reader.errorString());
+
+  return image;
 }
 
-QImage AvatarProvider::requestImage (const QString &id, QSize *, const QSize &) {
-  return QImage(mAvatarsPath + id);
+// -----------------------------------------------------------------------------
+
+bool AvatarProvider::createAvatar (const QString &path, const QString &fileId) {
+  QImageReader reader(path);
+  reader.setAutoTransform(true);
+
+  // Do not decode all the pixels of a large photo.
+  const QSize sourceSize = reader.size();
+  if (sourceSize.width() > AVATAR_MAX_SIZE && sourceSize.height() > AVATAR_MAX_SIZE)
+    reader.setScaledSize(sourceSize.scaled(AVATAR_MAX_SIZE, AVATAR_MAX_SIZE, Qt::KeepAspectRatioByExpanding));
+
+  QImage image = reader.read();
+  if (image.isNull()) {
+    qWarning() << QStringLiteral("Unable to read avatar: `%1`. (%2)").arg(path).arg(reader.errorString());
+    return false;
+  }
+
+  // Avatars are displayed in circles: keep the center.
+  const int side = qMin(image.width(), image.height());
+  image = image.copy((image.width() - side) / 2, (image.height() - side) / 2, side, side);
+
+  const QString avatarsPath = ::Utils::coreStringToAppString(Paths::getAvatarsDirPath());
+  for (int size = AVATAR_MAX_SIZE; size >= AVATAR_MIN_SIZE; size /= 2) {
+    const QImage avatar = side > size
+      ? image.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+      : image;
+
+    const QString avatarPath = ::getAvatarFilePath(avatarsPath, fileId, size);
+    if (!avatar.save(avatarPath, "png")) {
+      qWarning() << QStringLiteral("Unable to save avatar: `%1`.").arg(avatarPath);
+      removeAvatar(fileId);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool AvatarProvider::removeAvatar (const QString &fileId) {
+  const QString avatarsPath = ::Utils::coreStringToAppString(Paths::getAvatarsDirPath());
+
+  // The other sizes do not exist if the avatar was saved before the normalization.
+  for (int size = AVATAR_MIN_SIZE; size < AVATAR_MAX_SIZE; size *= 2)
+    QFile::remove(::getAvatarFilePath(avatarsPath, fileId, size));
+
+  return QFile::remove(::getAvatarFilePath(avatarsPath, fileId, AVATAR_MAX_SIZE));
 }
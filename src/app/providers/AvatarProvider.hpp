@@ -23,6 +23,8 @@
 #ifndef AVATAR_PROVIDER_H_
 #define AVATAR_PROVIDER_H_
 
+#include <QCache>
+#include <QMutex>
 #include <QQuickImageProvider>
 
 // =============================================================================
@@ -32,12 +34,24 @@ public:
   AvatarProvider ();
   ~AvatarProvider () = default;
 
+  // Returns the smallest normalized size of the avatar covering `requestedSize`.
   QImage requestImage (const QString &id, QSize *size, const QSize &requestedSize) override;
 
+  // Saves a square copy of an image in the avatars folder for each normalized size.
+  static bool createAvatar (const QString &path, const QString &fileId);
+  static bool removeAvatar (const QString &fileId);
+
   static const QString PROVIDER_ID;
 
 private:
+  QImage loadImage (const QString &id, int size) const;
+
   QString mAvatarsPath;
+
+  // Decoded images by size and id, the cost is in kilobytes.
+  // Images are requested by the loader threads of the engine.
+  QCache<QString, QImage> mImages;
+  QMutex mImagesMutex;
 };
 
 #endif // AVATAR_PROVIDER_H_
@@ -0,0 +1,94 @@
+/*
+ * Benchmark.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QtDebug>
+
+#include "Benchmark.hpp"
+
+using namespace std;
+
+// =============================================================================
+
+Benchmark::Benchmark (int iterations) {
+  Q_ASSERT(iterations > 0);
+  mIterations = iterations;
+}
+
+// -----------------------------------------------------------------------------
+
+void Benchmark::runTimed (const QString &name, const function<qint64()> &function, int operations) {
+  qInfo() << QStringLiteral("Run benchmark `%1` (%2 iterations)...").arg(name).arg(mIterations);
+
+  QVector<qint64> samples;
+  samples.reserve(mIterations);
+  for (int i = 0; i < mIterations; ++i)
+    samples << function();
+
+  addResult(name, samples, operations);
+}
+
+void Benchmark::run (const QString &name, const function<void()> &function, int operations) {
+  runTimed(name, [&function] {
+    return measure(function);
+  }, operations);
+}
+
+void Benchmark::addResult (const QString &name, QVector<qint64> samples, int operations) {
+  Q_ASSERT(!samples.isEmpty());
+
+  sort(samples.begin(), samples.end());
+
+  qint64 total = 0;
+  for (const auto &sample : samples)
+    total += sample;
+
+  // Times are exported in milliseconds.
+  auto toMs = [](qint64 ns) {
+    return static_cast<double>(ns) / 1e6;
+  };
+
+  QJsonObject result;
+  result["name"] = name;
+  result["iterations"] = samples.count();
+  result["operations"] = operations;
+  result["minMs"] = toMs(samples.first());
+  result["medianMs"] = toMs(samples[samples.count() / 2]);
+  result["meanMs"] = toMs(total / samples.count());
+  result["maxMs"] = toMs(samples.last());
+  result["medianPerOperationUs"] = static_cast<double>(samples[samples.count() / 2]) / 1e3 / max(operations, 1);
+
+  qInfo() << QStringLiteral("Benchmark `%1`: median %2 ms.").arg(name).arg(result["medianMs"].toDouble());
+
+  mResults << result;
+}
+
+// -----------------------------------------------------------------------------
+
+qint64 Benchmark::measure (const function<void()> &function) {
+  QElapsedTimer timer;
+  timer.start();
+  function();
+  return timer.nsecsElapsed();
+}
@@ -0,0 +1,66 @@
+/*
+ * Benchmark.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <functional>
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVector>
+
+// =============================================================================
+
+// Runs timed cases and collects their results.
+class Benchmark {
+public:
+  Benchmark (int iterations);
+  ~Benchmark () = default;
+
+  int getIterations () const {
+    return mIterations;
+  }
+
+  // Calls `function` once per iteration. `function` returns the measured time
+  // in nanoseconds, so set up and tear down can be excluded.
+  // `operations` is the number of operations done by one iteration.
+  void runTimed (const QString &name, const std::function<qint64()> &function, int operations = 1);
+
+  // Runs `function` once per iteration and measures the whole call.
+  void run (const QString &name, const std::function<void()> &function, int operations = 1);
+
+  // Adds a result measured outside of the runner. Samples are in nanoseconds.
+  void addResult (const QString &name, QVector<qint64> samples, int operations = 1);
+
+  QJsonArray getResults () const {
+    return mResults;
+  }
+
+  static qint64 measure (const std::function<void()> &function);
+
+private:
+  int mIterations;
+  QJsonArray mResults;
+};
+
+#endif // BENCHMARK_H_
@@ -0,0 +1,667 @@
+/*
+ * BenchmarkCases.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <random>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QThread>
+#include <QTimer>
+
+#include "../app/paths/Paths.hpp"
+#include "../app/providers/AvatarProvider.hpp"
+#include "../components/chat/ChatProxyModel.hpp"
+#include "../components/chat/ThumbnailGenerator.hpp"
+#include "../components/contacts/ContactsListProxyModel.hpp"
+#include "../components/core/CoreManager.hpp"
+#include "../components/message-search/MessageSearchIndex.hpp"
+#include "../components/sip-addresses/SipAddressesProxyModel.hpp"
+#include "../components/timeline/TimelineModel.hpp"
+#include "../utils/Utils.hpp"
+
+#include "Benchmark.hpp"
+#include "BenchmarkHttpServer.hpp"
+#include "BenchmarkSeeder.hpp"
+
+#include "BenchmarkCases.hpp"
+
+// Number of distinct chat rooms opened by the `ChatModel` case.
+#define CHAT_ROOMS_TO_OPEN 10
+
+// Greater than the `SipAddressesModel` flush interval.
+#define FLUSH_WAIT_TIME 20
+
+// A photo of 12 megapixels.
+#define THUMBNAIL_SOURCE_WIDTH 4000
+#define THUMBNAIL_SOURCE_HEIGHT 3000
+
+// Words of the messages indexed by the message search case.
+#define SEARCH_VOCABULARY_SIZE 20000
+#define SEARCH_MESSAGE_MAX_WORDS 20
+#define SEARCH_RESULTS_LIMIT 200
+
+// In milliseconds. Max duration of the upload case.
+#define UPLOAD_TIMEOUT 600000
+
+// In milliseconds. Max duration of the contacts import case.
+#define IMPORT_TIMEOUT 600000
+
+// Distinct avatars of the contacts list, and their size in the view.
+#define AVATARS_COUNT 8
+#define AVATAR_VIEW_SIZE 40
+
+using namespace std;
+
+// =============================================================================
+
+// Simulates a user typing `pattern`. Returns the time spent in the filters.
+template<class T>
+inline qint64 typePattern (T &proxyModel, const QString &pattern) {
+  proxyModel.setFilter(QString(""));
+
+  qint64 time = 0;
+  for (int i = 1; i <= pattern.length(); ++i) {
+    const QString filter = pattern.left(i);
+    time += Benchmark::measure([&proxyModel, &filter] {
+      proxyModel.setFilter(filter);
+    });
+  }
+
+  return time;
+}
+
+// Reads a field of the process status in kilobytes, -1 if unavailable.
+inline qint64 getMemoryStatus (const QByteArray &field) {
+  QFile file("/proc/self/status");
+  if (!file.open(QIODevice::ReadOnly))
+    return -1;
+
+  for (const QByteArray &line : file.readAll().split('\n'))
+    if (line.startsWith(field))
+      return line.mid(field.length()).trimmed().split(' ').first().toLongLong();
+  return -1;
+}
+
+// Resident set size of the process.
+inline qint64 getMemoryUsage () {
+  return ::getMemoryStatus("VmRSS:");
+}
+
+// Peak resident set size of the process.
+inline qint64 getPeakMemoryUsage () {
+  return ::getMemoryStatus("VmHWM:");
+}
+
+// Resets the peak resident set size (Linux >= 4.0).
+inline void resetPeakMemoryUsage () {
+  QFile file("/proc/self/clear_refs");
+  if (file.open(QIODevice::WriteOnly))
+    file.write("5");
+}
+
+// -----------------------------------------------------------------------------
+
+inline void runContactsCases (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  int contactsCount = seeder.getVolumes().contacts;
+
+  benchmark.run("contacts_list_model.init", [] {
+    ContactsListModel model;
+  }, contactsCount);
+
+  {
+    qint64 memoryUsage = ::getMemoryUsage();
+    ContactsListModel model;
+    qInfo() << QStringLiteral("Memory used by a contacts list model of %1 contacts: %2kB.")
+      .arg(contactsCount).arg(::getMemoryUsage() - memoryUsage);
+  }
+
+  benchmark.run("contacts_list_proxy_model.init", [] {
+    ContactsListProxyModel proxyModel;
+  }, contactsCount);
+
+  // The first chat rooms are linked to contacts.
+  {
+    ContactsListModel *model = CoreManager::getInstance()->getContactsListModel();
+    int count = qMin(contactsCount, seeder.getVolumes().chatRooms);
+
+    QStringList sipAddresses;
+    for (int i = 0; i < count; ++i)
+      sipAddresses << seeder.getPeerSipAddress(i);
+
+    benchmark.run("contacts_list_model.find_contact_from_sip_address", [model, &sipAddresses] {
+      for (const QString &sipAddress : sipAddresses)
+        model->findContactModelFromSipAddress(sipAddress);
+    }, count);
+  }
+
+  ContactsListProxyModel proxyModel;
+  const QString pattern = seeder.getSearchPattern();
+  benchmark.runTimed("contacts_list_proxy_model.filter", [&proxyModel, &pattern] {
+    return ::typePattern(proxyModel, pattern);
+  }, pattern.length());
+}
+
+inline void runSipAddressesCases (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  const BenchmarkSeeder::Volumes &volumes = seeder.getVolumes();
+  int entriesCount = CoreManager::getInstance()->getSipAddressesModel()->rowCount();
+
+  // Init without index: history of each chat room is read.
+  benchmark.runTimed("sip_addresses_model.init.rebuild", [] {
+    QFile::remove(::Utils::coreStringToAppString(Paths::getSipAddressesIndexFilePath()));
+
+    SipAddressesModel *model = nullptr;
+    qint64 time = Benchmark::measure([&model] {
+      model = new SipAddressesModel();
+    });
+    delete model;
+
+    return time;
+  }, volumes.chatRooms * volumes.messagesPerChatRoom);
+
+  benchmark.runTimed("sip_addresses_model.init.indexed", [] {
+    SipAddressesModel *model = nullptr;
+    qint64 time = Benchmark::measure([&model] {
+      model = new SipAddressesModel();
+    });
+    delete model;
+
+    return time;
+  }, entriesCount);
+
+  // Presence of each entry is updated, then changes are flushed.
+  {
+    SipAddressesModel *model = CoreManager::getInstance()->getSipAddressesModel();
+    shared_ptr<CoreHandlers> coreHandlers = CoreManager::getInstance()->getHandlers();
+    shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
+
+    QStringList sipAddresses;
+    for (int i = 0; i < entriesCount; ++i)
+      sipAddresses << model->data(model->index(i, 0), SipAddressesModel::SipAddressRole).toString();
+
+    const shared_ptr<const linphone::PresenceModel> presenceModels[] = {
+      core->createPresenceModelWithActivity(linphone::PresenceActivityTypeOnline, ""),
+      core->createPresenceModelWithActivity(linphone::PresenceActivityTypeBusy, "")
+    };
+
+    // Views which depend on the sip addresses.
+    SipAddressesProxyModel proxyModel;
+    TimelineModel timelineModel;
+
+    int iteration = 0;
+    benchmark.runTimed("sip_addresses_model.presence_update", [&] {
+      const shared_ptr<const linphone::PresenceModel> &presenceModel = presenceModels[iteration++ % 2];
+
+      qint64 time = Benchmark::measure([&] {
+        for (const auto &sipAddress : sipAddresses)
+          emit coreHandlers->presenceReceived(sipAddress, presenceModel);
+      });
+
+      QThread::msleep(FLUSH_WAIT_TIME);
+      return time + Benchmark::measure([] {
+        QCoreApplication::processEvents();
+      });
+    }, entriesCount);
+  }
+
+  // Created at startup by the search bar. Filtering and sorting must not create the contact models.
+  qint64 memoryUsage = ::getMemoryUsage();
+  SipAddressesProxyModel proxyModel;
+  qInfo() << QStringLiteral("Memory used by a sip addresses proxy model of %1 entries: %2kB.")
+    .arg(entriesCount).arg(::getMemoryUsage() - memoryUsage);
+
+  benchmark.run("sip_addresses_proxy_model.init", [] {
+    SipAddressesProxyModel proxyModel;
+  }, entriesCount);
+
+  const QString pattern = seeder.getSearchPattern();
+  benchmark.runTimed("sip_addresses_proxy_model.filter", [&proxyModel, &pattern] {
+    return ::typePattern(proxyModel, pattern);
+  }, pattern.length());
+
+  benchmark.run("timeline_model.init", [] {
+    TimelineModel timelineModel;
+  }, entriesCount);
+}
+
+inline void runChatCases (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  const BenchmarkSeeder::Volumes &volumes = seeder.getVolumes();
+  int chatRoomsCount = qMin(volumes.chatRooms, CHAT_ROOMS_TO_OPEN);
+  if (chatRoomsCount == 0)
+    return;
+
+  int iteration = 0;
+  benchmark.runTimed("chat_model.set_sip_address", [&seeder, &iteration, chatRoomsCount] {
+    const QString sipAddress = seeder.getPeerSipAddress(iteration++ % chatRoomsCount);
+
+    ChatModel chatModel;
+    return Benchmark::measure([&chatModel, &sipAddress] {
+      chatModel.setSipAddress(sipAddress);
+    });
+  });
+
+  // Previous page of history.
+  iteration = 0;
+  benchmark.runTimed("chat_model.load_more_entries", [&seeder, &iteration, chatRoomsCount] {
+    ChatModel chatModel;
+    chatModel.setSipAddress(seeder.getPeerSipAddress(iteration++ % chatRoomsCount));
+
+    return Benchmark::measure([&chatModel] {
+      chatModel.loadMoreEntries();
+    });
+  });
+
+  // Switches between recent chats, kept loaded by `ChatModelsCache`.
+  {
+    ChatProxyModel proxyModel;
+    for (int i = 0; i < chatRoomsCount; ++i)
+      proxyModel.setSipAddress(seeder.getPeerSipAddress(i));
+
+    iteration = 0;
+    benchmark.run("chat_proxy_model.switch_recent_chat", [&proxyModel, &seeder, &iteration, chatRoomsCount] {
+      proxyModel.setSipAddress(seeder.getPeerSipAddress(iteration++ % chatRoomsCount));
+    });
+  }
+
+  // Whole history of 10k messages and 5k calls.
+  if (volumes.busyConversation) {
+    benchmark.runTimed("chat_model.load_busy_conversation", [] {
+      ChatModel chatModel;
+      return Benchmark::measure([&chatModel] {
+        chatModel.setSipAddress(BenchmarkSeeder::getBusySipAddress());
+        while (chatModel.loadMoreEntries() > 0) {}
+      });
+    });
+  }
+
+  // Filter switches on the busy conversation, with all its entries loaded.
+  if (volumes.busyConversation) {
+    ChatProxyModel proxyModel;
+    proxyModel.setSipAddress(BenchmarkSeeder::getBusySipAddress());
+    for (int count = -1; count != proxyModel.rowCount();) {
+      count = proxyModel.rowCount();
+      proxyModel.loadMoreEntries();
+    }
+
+    benchmark.run("chat_proxy_model.set_entry_type_filter", [&proxyModel] {
+      proxyModel.setEntryTypeFilter(ChatModel::MessageEntry);
+      proxyModel.setEntryTypeFilter(ChatModel::CallEntry);
+      proxyModel.setEntryTypeFilter(ChatModel::GenericEntry);
+    }, 3);
+  }
+
+  // Destructive: only once, on the last chat room.
+  {
+    ChatModel chatModel;
+    chatModel.setSipAddress(seeder.getPeerSipAddress(volumes.chatRooms - 1));
+
+    qint64 clear = Benchmark::measure([&chatModel] {
+      chatModel.removeAllEntries();
+    });
+    qint64 storage = Benchmark::measure([] {
+      QCoreApplication::processEvents();
+    });
+
+    benchmark.addResult("chat_model.remove_all_entries", QVector<qint64>() << clear);
+    benchmark.addResult("chat_model.remove_all_entries.storage", QVector<qint64>() << storage);
+  }
+}
+
+// Compares the thumbnail creation in the GUI thread (previous implementation)
+// with the GUI thread stall of `ThumbnailGenerator`.
+inline void runThumbnailCases (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  if (seeder.getVolumes().chatRooms == 0)
+    return;
+
+  const QString imagePath = ::Utils::coreStringToAppString(Paths::getDownloadDirPath()) + "bench.jpg";
+  {
+    QImage image(THUMBNAIL_SOURCE_WIDTH, THUMBNAIL_SOURCE_HEIGHT, QImage::Format_RGB32);
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, THUMBNAIL_SOURCE_WIDTH, THUMBNAIL_SOURCE_HEIGHT);
+    gradient.setColorAt(0, Qt::darkBlue);
+    gradient.setColorAt(1, Qt::yellow);
+    painter.fillRect(image.rect(), gradient);
+    if (!image.save(imagePath, "jpg")) {
+      qWarning() << QStringLiteral("Unable to create image: `%1`.").arg(imagePath);
+      return;
+    }
+  }
+
+  benchmark.run("thumbnail.create_in_gui_thread", [&imagePath] {
+    QImage(imagePath).scaled(100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation).save(
+      QStringLiteral("%1.thumbnail.jpg").arg(imagePath), "jpg", 100
+    );
+  });
+
+  shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
+  shared_ptr<linphone::ChatRoom> chatRoom = core->getChatRoomFromUri(
+    ::Utils::appStringToCoreString(seeder.getPeerSipAddress(0))
+  );
+
+  ThumbnailGenerator *generator = ThumbnailGenerator::getInstance();
+  QVector<qint64> latencies;
+
+  benchmark.runTimed("thumbnail_generator.gui_thread_stall", [&] {
+    shared_ptr<linphone::Content> content = core->createContent();
+    content->setType("image");
+    content->setSubtype("jpeg");
+    content->setName("bench.jpg");
+
+    shared_ptr<linphone::ChatMessage> message = chatRoom->createFileTransferMessage(content);
+    message->setFileTransferFilepath(::Utils::appStringToCoreString(imagePath));
+
+    QEventLoop loop;
+    QObject::connect(generator, &ThumbnailGenerator::thumbnailCreated, &loop, &QEventLoop::quit);
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 stall = Benchmark::measure([generator, &message] {
+      generator->createThumbnail(message);
+    });
+
+    loop.exec();
+    latencies << timer.nsecsElapsed();
+
+    return stall;
+  });
+
+  benchmark.addResult("thumbnail_generator.latency", latencies);
+}
+
+// The index is built from generated messages, with a vocabulary larger than the seeded history.
+inline void runMessageSearchCases (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  const BenchmarkSeeder::Volumes &volumes = seeder.getVolumes();
+  int messagesCount = volumes.chatRooms * volumes.messagesPerChatRoom;
+  if (messagesCount == 0)
+    return;
+
+  mt19937 generator(static_cast<quint32>(messagesCount));
+
+  QStringList vocabulary;
+  for (int i = 0; i < SEARCH_VOCABULARY_SIZE; ++i) {
+    QString word;
+    for (int length = uniform_int_distribution<int>(3, 10)(generator); length > 0; --length)
+      word += QChar('a' + uniform_int_distribution<int>(0, 25)(generator));
+    vocabulary << word;
+  }
+
+  // Zipf-like distribution: some words are very common.
+  auto randomWord = [&generator, &vocabulary] {
+    double r = uniform_real_distribution<double>(0, 1)(generator);
+    return vocabulary[static_cast<int>(r * r * r * (SEARCH_VOCABULARY_SIZE - 1))];
+  };
+
+  QList<MessageSearchIndex::Message> messages;
+  messages.reserve(messagesCount);
+  for (int i = 0; i < messagesCount; ++i) {
+    MessageSearchIndex::Message message;
+    message.sipAddress = seeder.getPeerSipAddress(i % volumes.chatRooms);
+    message.timestamp = i * 1000;
+    message.storageId = static_cast<quint32>(i + 1);
+
+    QStringList words;
+    for (int n = uniform_int_distribution<int>(1, SEARCH_MESSAGE_MAX_WORDS)(generator); n > 0; --n)
+      words << randomWord();
+    message.text = words.join(' ');
+
+    messages << message;
+  }
+
+  const QString filePath = ::Utils::coreStringToAppString(Paths::getMessageSearchIndexFilePath()) + ".bench";
+  MessageSearchIndex index(filePath);
+
+  benchmark.addResult("message_search_index.add", QVector<qint64>() << Benchmark::measure([&index, &messages] {
+    index.add(messages, false);
+  }), messagesCount);
+
+  benchmark.addResult("message_search_index.save", QVector<qint64>() << Benchmark::measure([&index] {
+    index.save();
+  }));
+
+  benchmark.addResult("message_search_index.load", QVector<qint64>() << Benchmark::measure([&index] {
+    index.load();
+  }));
+
+  const QString commonWord = vocabulary.first();
+  const QString rareWord = vocabulary.last();
+
+  benchmark.run("message_search_index.search.common_word", [&index, &commonWord] {
+    index.search(commonWord + ' ', SEARCH_RESULTS_LIMIT);
+  });
+
+  benchmark.run("message_search_index.search.two_words", [&index, &commonWord, &rareWord] {
+    index.search(commonWord + ' ' + rareWord + ' ', SEARCH_RESULTS_LIMIT);
+  });
+
+  // Each letter of a word, as typed by the user.
+  benchmark.runTimed("message_search_index.search.typing", [&index, &vocabulary, &randomWord] {
+    const QString pattern = vocabulary[SEARCH_VOCABULARY_SIZE / 2] + ' ' + randomWord();
+    return Benchmark::measure([&index, &pattern] {
+      for (int i = 1; i <= pattern.length(); ++i)
+        index.search(pattern.left(i), SEARCH_RESULTS_LIMIT);
+    });
+  });
+
+  QFile::remove(filePath);
+  QFile::remove(filePath + ".journal");
+}
+
+// Sends a large file to a local file transfer server.
+// The memory used must not depend on the file size.
+inline void runUploadCases (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  const BenchmarkSeeder::Volumes &volumes = seeder.getVolumes();
+  if (volumes.uploadSize == 0 || volumes.chatRooms == 0)
+    return;
+
+  const qint64 fileSize = static_cast<qint64>(volumes.uploadSize) * 1024 * 1024;
+
+  // Sparse file: no disk space is used.
+  const QString filePath = ::Utils::coreStringToAppString(Paths::getDownloadDirPath()) + "bench-upload.bin";
+  {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || !file.resize(fileSize)) {
+      qWarning() << QStringLiteral("Unable to create file: `%1`.").arg(filePath);
+      return;
+    }
+  }
+
+  BenchmarkHttpServer server;
+  if (!server.start())
+    return;
+
+  SettingsModel *settingsModel = CoreManager::getInstance()->getSettingsModel();
+  const QString fileTransferUrl = settingsModel->getFileTransferUrl();
+  const int fileTransferSizeLimit = settingsModel->getFileTransferSizeLimit();
+  settingsModel->setFileTransferUrl(server.getUrl());
+  settingsModel->setFileTransferSizeLimit(0);
+
+  ChatModel chatModel;
+  chatModel.setSipAddress(seeder.getPeerSipAddress(0));
+
+  QEventLoop loop;
+  shared_ptr<linphone::ChatMessage> message;
+
+  QObject::connect(&chatModel, &ChatModel::messageSent, [&message](const shared_ptr<linphone::ChatMessage> &sentMessage) {
+    message = sentMessage;
+  });
+  // Without SIP server, the message is not delivered once uploaded.
+  QObject::connect(&chatModel, &ChatModel::dataChanged, [&loop, &message] {
+    if (!message)
+      return;
+
+    linphone::ChatMessageState state = message->getState();
+    if (state != linphone::ChatMessageStateIdle && state != linphone::ChatMessageStateInProgress)
+      loop.quit();
+  });
+  QTimer::singleShot(UPLOAD_TIMEOUT, &loop, &QEventLoop::quit);
+
+  ::resetPeakMemoryUsage();
+
+  qint64 time = Benchmark::measure([&chatModel, &filePath, &loop] {
+    chatModel.sendFileMessage(filePath);
+    loop.exec();
+  });
+
+  if (server.getReceivedBytesCount() < fileSize)
+    qWarning() << QStringLiteral("File upload failed: %1/%2 bytes received.")
+      .arg(server.getReceivedBytesCount()).arg(fileSize);
+  else {
+    benchmark.addResult("chat_model.send_file_message.upload", QVector<qint64>() << time, volumes.uploadSize);
+    qInfo() << QStringLiteral("Peak memory usage during upload of %1MB: %2kB.")
+      .arg(volumes.uploadSize).arg(::getPeakMemoryUsage());
+  }
+
+  settingsModel->setFileTransferUrl(fileTransferUrl);
+  settingsModel->setFileTransferSizeLimit(fileTransferSizeLimit);
+
+  QFile::remove(filePath);
+}
+
+// Emulates a scroll of the contacts list: one avatar request per contact,
+// with a few distinct photos of 12 megapixels.
+inline void runAvatarCases (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  const int contactsCount = seeder.getVolumes().contacts;
+  if (contactsCount == 0)
+    return;
+
+  const QString avatarsPath = ::Utils::coreStringToAppString(Paths::getAvatarsDirPath());
+  const QString imagePath = avatarsPath + "bench-original.jpg";
+  {
+    QImage image(THUMBNAIL_SOURCE_WIDTH, THUMBNAIL_SOURCE_HEIGHT, QImage::Format_RGB32);
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, THUMBNAIL_SOURCE_WIDTH, THUMBNAIL_SOURCE_HEIGHT);
+    gradient.setColorAt(0, Qt::darkGreen);
+    gradient.setColorAt(1, Qt::white);
+    painter.fillRect(image.rect(), gradient);
+    if (!image.save(imagePath, "jpg")) {
+      qWarning() << QStringLiteral("Unable to create image: `%1`.").arg(imagePath);
+      return;
+    }
+  }
+
+  // Detached vcards remove their avatars when destroyed.
+  QList<VcardModel *> vcardModels;
+  QStringList ids;
+  QVector<qint64> samples;
+  for (int i = 0; i < AVATARS_COUNT; ++i) {
+    VcardModel *vcardModel = new VcardModel(linphone::Factory::get()->createVcard(), false);
+    vcardModels << vcardModel;
+
+    samples << Benchmark::measure([vcardModel, &imagePath] {
+      vcardModel->setAvatar(imagePath);
+    });
+    ids << vcardModel->getAvatar().section('/', -1);
+  }
+  benchmark.addResult("vcard_model.set_avatar", samples);
+
+  const QSize viewSize(AVATAR_VIEW_SIZE, AVATAR_VIEW_SIZE);
+
+  // Avatar set before the normalization.
+  benchmark.runTimed("avatar_provider.request_image.original", [&viewSize] {
+    AvatarProvider provider;
+    return Benchmark::measure([&provider, &viewSize] {
+      provider.requestImage("bench-original.jpg", nullptr, viewSize);
+    });
+  });
+
+  benchmark.runTimed("avatar_provider.request_image.scroll", [contactsCount, &ids, &viewSize] {
+    AvatarProvider provider;
+    return Benchmark::measure([&provider, contactsCount, &ids, &viewSize] {
+      for (int i = 0; i < contactsCount; ++i)
+        provider.requestImage(ids[i % ids.count()], nullptr, viewSize);
+    });
+  }, contactsCount);
+
+  {
+    qint64 memoryUsage = ::getMemoryUsage();
+    AvatarProvider provider;
+    for (int i = 0; i < contactsCount; ++i)
+      provider.requestImage(ids[i % ids.count()], nullptr, viewSize);
+    qInfo() << QStringLiteral("Memory used by the avatars of %1 contacts: %2kB.")
+      .arg(contactsCount).arg(::getMemoryUsage() - memoryUsage);
+  }
+
+  qDeleteAll(vcardModels);
+  QFile::remove(imagePath);
+}
+
+// Imports a vcf file of new contacts. Their sip addresses are the peers without contact.
+// Must be the last case: the imported contacts are saved in the friends database.
+inline void runImportCases (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  const BenchmarkSeeder::Volumes &volumes = seeder.getVolumes();
+  const int count = volumes.contacts;
+  if (count == 0)
+    return;
+
+  const QString filePath = ::Utils::coreStringToAppString(Paths::getDownloadDirPath()) + "bench-import.vcf";
+  {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+      qWarning() << QStringLiteral("Unable to create file: `%1`.").arg(filePath);
+      return;
+    }
+
+    for (int i = 0; i < count; ++i)
+      file.write(
+        QStringLiteral("BEGIN:VCARD\r\nVERSION:4.0\r\nFN:Imported %1\r\nIMPP:%2\r\nEND:VCARD\r\n")
+        .arg(i).arg(seeder.getPeerSipAddress(volumes.contacts + i)).toUtf8()
+      );
+  }
+
+  ContactsListModel *model = CoreManager::getInstance()->getContactsListModel();
+
+  QEventLoop loop;
+  int importedCount = 0;
+  QObject::connect(model, &ContactsListModel::importFinished, &loop, [&loop, &importedCount](int imported) {
+    importedCount = imported;
+    loop.quit();
+  });
+  QTimer::singleShot(IMPORT_TIMEOUT, &loop, &QEventLoop::quit);
+
+  qint64 time = Benchmark::measure([model, &filePath, &loop] {
+    if (model->importContacts(filePath))
+      loop.exec();
+  });
+
+  if (importedCount != count)
+    qWarning() << QStringLiteral("Contacts import failed: %1/%2 contacts imported.").arg(importedCount).arg(count);
+  else
+    benchmark.addResult("contacts_list_model.import_contacts", QVector<qint64>() << time, count);
+
+  QFile::remove(filePath);
+}
+
+// -----------------------------------------------------------------------------
+
+void BenchmarkCases::run (Benchmark &benchmark, const BenchmarkSeeder &seeder) {
+  ::runContactsCases(benchmark, seeder);
+  ::runSipAddressesCases(benchmark, seeder);
+  ::runChatCases(benchmark, seeder);
+  ::runThumbnailCases(benchmark, seeder);
+  ::runMessageSearchCases(benchmark, seeder);
+  ::runUploadCases(benchmark, seeder);
+  ::runAvatarCases(benchmark, seeder);
+  ::runImportCases(benchmark, seeder);
+}
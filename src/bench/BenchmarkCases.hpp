@@ -0,0 +1,36 @@
+/*
+ * BenchmarkCases.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef BENCHMARK_CASES_H_
+#define BENCHMARK_CASES_H_
+
+// =============================================================================
+
+class Benchmark;
+class BenchmarkSeeder;
+
+namespace BenchmarkCases {
+  // Must be called once the core is started.
+  void run (Benchmark &benchmark, const BenchmarkSeeder &seeder);
+}
+
+#endif // BENCHMARK_CASES_H_
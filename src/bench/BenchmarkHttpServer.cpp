@@ -0,0 +1,152 @@
+/*
+ * BenchmarkHttpServer.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <QTcpSocket>
+#include <QtDebug>
+
+#include "BenchmarkHttpServer.hpp"
+
+#define HEADERS_END "\r\n\r\n"
+
+// In bytes. Chunk of the body read then discarded.
+#define READ_BUFFER_SIZE 65536
+
+// Validity of the uploaded files. Not checked by the bench.
+#define FILE_VALIDITY "2099-12-31T23:59:59Z"
+
+using namespace std;
+
+// =============================================================================
+
+inline qint64 getContentLength (const QByteArray &headers) {
+  for (const QByteArray &line : headers.split('\n')) {
+    const int index = line.indexOf(':');
+    if (index > 0 && line.left(index).trimmed().toLower() == "content-length")
+      return line.mid(index + 1).trimmed().toLongLong();
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+BenchmarkHttpServer::BenchmarkHttpServer (QObject *parent) : QTcpServer(parent) {
+  QObject::connect(this, &QTcpServer::newConnection, this, &BenchmarkHttpServer::handleNewConnection);
+}
+
+bool BenchmarkHttpServer::start () {
+  if (!listen(QHostAddress::LocalHost)) {
+    qWarning() << QStringLiteral("Unable to start http server: `%1`.").arg(errorString());
+    return false;
+  }
+  return true;
+}
+
+QString BenchmarkHttpServer::getUrl () const {
+  return QStringLiteral("http://127.0.0.1:%1/").arg(serverPort());
+}
+
+// -----------------------------------------------------------------------------
+
+void BenchmarkHttpServer::handleNewConnection () {
+  while (QTcpSocket *socket = nextPendingConnection()) {
+    mRequests[socket] = Request();
+
+    QObject::connect(socket, &QTcpSocket::readyRead, this, [this, socket] {
+      handleReadyRead(socket);
+    });
+    QObject::connect(socket, &QTcpSocket::disconnected, this, [this, socket] {
+      mRequests.remove(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+// Requests are read in place: the body is never buffered.
+void BenchmarkHttpServer::handleReadyRead (QTcpSocket *socket) {
+  Request &request = mRequests[socket];
+
+  while (socket->bytesAvailable() > 0) {
+    if (request.remainingBodySize < 0) {
+      request.headers += socket->read(socket->bytesAvailable());
+
+      const int index = request.headers.indexOf(HEADERS_END);
+      if (index < 0)
+        continue;
+
+      // Start of the body, or of the next request.
+      const QByteArray rest = request.headers.mid(index + sizeof(HEADERS_END) - 1);
+      request.headers.truncate(index);
+      request.bodySize = request.remainingBodySize = ::getContentLength(request.headers);
+
+      const qint64 size = qMin(static_cast<qint64>(rest.size()), request.remainingBodySize);
+      request.remainingBodySize -= size;
+      mReceivedBytesCount += size;
+
+      if (request.remainingBodySize == 0) {
+        sendResponse(socket, request);
+        request = Request();
+        request.headers = rest.mid(static_cast<int>(size));
+      }
+    } else {
+      char buffer[READ_BUFFER_SIZE];
+      const qint64 size = socket->read(buffer, qMin(request.remainingBodySize, static_cast<qint64>(READ_BUFFER_SIZE)));
+      if (size <= 0)
+        break;
+
+      request.remainingBodySize -= size;
+      mReceivedBytesCount += size;
+
+      if (request.remainingBodySize == 0) {
+        sendResponse(socket, request);
+        request = Request();
+      }
+    }
+  }
+}
+
+// An empty request asks for the upload, a non-empty request contains the file.
+void BenchmarkHttpServer::sendResponse (QTcpSocket *socket, const Request &request) {
+  if (request.bodySize == 0) {
+    socket->write("HTTP/1.1 204 No Content\r\nContent-Length: 0\r\n\r\n");
+    return;
+  }
+
+  const QByteArray body = QStringLiteral(
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<file xmlns=\"urn:gsma:params:xml:ns:rcs:rcs:fthttp\">\n"
+    "<file-info type=\"file\">\n"
+    "<file-size>%1</file-size>\n"
+    "<file-name>bench</file-name>\n"
+    "<content-type>application/octet-stream</content-type>\n"
+    "<data url=\"%2bench\" until=\"%3\"/>\n"
+    "</file-info>\n"
+    "</file>\n"
+  ).arg(request.bodySize).arg(getUrl()).arg(FILE_VALIDITY).toUtf8();
+
+  socket->write(
+    QStringLiteral(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/vnd.gsma.rcs-ft-http+xml\r\n"
+      "Content-Length: %1\r\n\r\n"
+    ).arg(body.size()).toUtf8() + body
+  );
+}
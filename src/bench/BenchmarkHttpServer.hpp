@@ -0,0 +1,64 @@
+/*
+ * BenchmarkHttpServer.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef BENCHMARK_HTTP_SERVER_H_
+#define BENCHMARK_HTTP_SERVER_H_
+
+#include <QHash>
+#include <QTcpServer>
+
+// =============================================================================
+
+// Minimal file transfer server (RCS file transfer over HTTP) on the loopback.
+// Uploaded files are discarded, only their size is kept.
+class BenchmarkHttpServer : public QTcpServer {
+  Q_OBJECT;
+
+public:
+  BenchmarkHttpServer (QObject *parent = Q_NULLPTR);
+  ~BenchmarkHttpServer () = default;
+
+  bool start ();
+
+  QString getUrl () const;
+
+  qint64 getReceivedBytesCount () const {
+    return mReceivedBytesCount;
+  }
+
+private:
+  struct Request {
+    QByteArray headers;
+    qint64 remainingBodySize = -1; // -1 while the headers are read.
+    qint64 bodySize = 0;
+  };
+
+  void handleNewConnection ();
+  void handleReadyRead (QTcpSocket *socket);
+
+  void sendResponse (QTcpSocket *socket, const Request &request);
+
+  QHash<QTcpSocket *, Request> mRequests;
+  qint64 mReceivedBytesCount = 0;
+};
+
+#endif // BENCHMARK_HTTP_SERVER_H_
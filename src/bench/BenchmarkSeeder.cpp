@@ -0,0 +1,332 @@
+/*
+ * BenchmarkSeeder.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtDebug>
+
+#include "../app/paths/Paths.hpp"
+#include "../utils/Utils.hpp"
+
+#include "BenchmarkSeeder.hpp"
+
+#define BENCH_DOMAIN "bench.linphone.org"
+
+#define DB_CONNECTION_NAME "linphone-bench-seeder"
+
+#define ONE_YEAR 31536000 // In seconds.
+
+// Values of the linphone enums written in the databases.
+#define CALL_DIR_OUTGOING 0
+#define CALL_DIR_INCOMING 1
+
+#define CALL_STATUS_SUCCESS 0
+#define CALL_STATUS_MISSED 2
+
+#define MESSAGE_DIR_INCOMING 0
+#define MESSAGE_DIR_OUTGOING 1
+
+#define MESSAGE_STATE_DELIVERED 2
+
+// 1 unread message per chat room of this modulo.
+#define UNREAD_CHAT_ROOM_MODULO 10
+
+// A conversation with many messages interleaved with calls.
+#define BUSY_CONVERSATION_MESSAGES_COUNT 10000
+#define BUSY_CONVERSATION_CALL_LOGS_COUNT 5000
+#define BUSY_CONVERSATION_MESSAGES_INTERVAL 60 // In seconds.
+
+using namespace std;
+
+// =============================================================================
+
+// Same schemas as the linphone storages. Missing columns are added by the core.
+
+static const char *FriendsSchema[] = {
+  "CREATE TABLE IF NOT EXISTS friends_lists ("
+  "id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT, rls_uri TEXT, sync_uri TEXT, revision INTEGER)",
+  "CREATE TABLE IF NOT EXISTS friends ("
+  "id INTEGER PRIMARY KEY AUTOINCREMENT, friend_list_id INTEGER, sip_uri TEXT, subscribe_policy INTEGER, "
+  "send_subscribe INTEGER, ref_key TEXT, vCard TEXT, vCard_etag TEXT, vCard_url TEXT, presence_received INTEGER)"
+};
+
+static const char *MessagesSchema[] = {
+  "CREATE TABLE IF NOT EXISTS history ("
+  "id INTEGER PRIMARY KEY AUTOINCREMENT, localContact TEXT NOT NULL, remoteContact TEXT NOT NULL, "
+  "direction INTEGER, message TEXT, time TEXT NOT NULL, read INTEGER, status INTEGER, utc INTEGER)"
+};
+
+static const char *CallLogsSchema[] = {
+  "CREATE TABLE IF NOT EXISTS call_history ("
+  "id INTEGER PRIMARY KEY AUTOINCREMENT, caller TEXT NOT NULL, callee TEXT NOT NULL, direction INTEGER, "
+  "duration INTEGER, start_time TEXT NOT NULL, connected_time TEXT NOT NULL, status INTEGER, "
+  "videoEnabled INTEGER, quality REAL, call_id TEXT, refkey TEXT)"
+};
+
+template<size_t N>
+inline QStringList toQueries (const char *(&schema)[N]) {
+  QStringList queries;
+  for (const auto &query : schema)
+    queries << QString(query);
+  return queries;
+}
+
+// -----------------------------------------------------------------------------
+
+BenchmarkSeeder::BenchmarkSeeder (const Volumes &volumes, quint32 seed) : mVolumes(volumes), mGenerator(seed) {
+  mFirstNames << "alice" << "bob" << "claire" << "david" << "emma" << "francois" << "gaelle" <<
+    "hugo" << "ines" << "jules" << "karine" << "louis" << "marie" << "nathan" << "oceane" << "pierre";
+  mLastNames << "bernard" << "dubois" << "fournier" << "garnier" << "lambert" << "leroy" << "manning" <<
+    "martin" << "mercier" << "moreau" << "petit" << "richard" << "robert" << "roux" << "simon" << "vincent";
+}
+
+// -----------------------------------------------------------------------------
+
+bool BenchmarkSeeder::seed () {
+  qInfo() << QStringLiteral("Seed %1 contacts, %2 chat rooms of %3 messages and %4 call logs...")
+    .arg(mVolumes.contacts).arg(mVolumes.chatRooms).arg(mVolumes.messagesPerChatRoom).arg(mVolumes.callLogs);
+
+  return seedFriends() && seedMessages() && seedCallLogs();
+}
+
+// -----------------------------------------------------------------------------
+
+QString BenchmarkSeeder::getPeerSipAddress (int index) const {
+  if (index < mVolumes.contacts) {
+    const QString &firstName = mFirstNames[index % mFirstNames.count()];
+    const QString &lastName = mLastNames[(index / mFirstNames.count()) % mLastNames.count()];
+    return QStringLiteral("sip:%1.%2.%3@" BENCH_DOMAIN).arg(firstName).arg(lastName).arg(index);
+  }
+
+  return QStringLiteral("sip:peer-%1@" BENCH_DOMAIN).arg(index);
+}
+
+QString BenchmarkSeeder::getSearchPattern () const {
+  return mFirstNames[mFirstNames.count() / 2] + " " + mLastNames[mLastNames.count() / 2];
+}
+
+QString BenchmarkSeeder::getBusySipAddress () {
+  return QStringLiteral("sip:busy@" BENCH_DOMAIN);
+}
+
+QString BenchmarkSeeder::getLocalSipAddress () {
+  return QStringLiteral("sip:me@" BENCH_DOMAIN);
+}
+
+// -----------------------------------------------------------------------------
+
+bool BenchmarkSeeder::seedFriends () {
+  QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", DB_CONNECTION_NAME);
+  database.setDatabaseName(::Utils::coreStringToAppString(Paths::getFriendsListFilePath()));
+
+  bool soFarSoGood = execQueries(database, toQueries(FriendsSchema));
+  if (soFarSoGood) {
+    database.transaction();
+
+    QSqlQuery query(database);
+    soFarSoGood = query.exec("INSERT INTO friends_lists (name, revision) VALUES ('bench', 0)");
+    qint64 friendListId = query.lastInsertId().toLongLong();
+
+    query.prepare(
+      "INSERT INTO friends (friend_list_id, sip_uri, subscribe_policy, send_subscribe, vCard, presence_received) "
+      "VALUES (?, ?, 1, 0, ?, 0)"
+    );
+
+    for (int i = 0; soFarSoGood && i < mVolumes.contacts; ++i) {
+      const QString sipAddress = getPeerSipAddress(i);
+      const QString firstName = mFirstNames[i % mFirstNames.count()];
+      const QString lastName = mLastNames[(i / mFirstNames.count()) % mLastNames.count()];
+
+      query.addBindValue(friendListId);
+      query.addBindValue(sipAddress);
+      query.addBindValue(
+        QStringLiteral("BEGIN:VCARD\r\nVERSION:4.0\r\nFN:%1 %2\r\nN:%2;%1;;;\r\nIMPP:%3\r\nEND:VCARD\r\n")
+        .arg(firstName).arg(lastName).arg(sipAddress)
+      );
+      soFarSoGood = query.exec();
+    }
+
+    if (!soFarSoGood)
+      qWarning() << QStringLiteral("Unable to seed friends:") << query.lastError().text();
+
+    database.commit();
+  }
+
+  database.close();
+  database = QSqlDatabase();
+  QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
+
+  return soFarSoGood;
+}
+
+bool BenchmarkSeeder::seedMessages () {
+  QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", DB_CONNECTION_NAME);
+  database.setDatabaseName(::Utils::coreStringToAppString(Paths::getMessageHistoryFilePath()));
+
+  bool soFarSoGood = execQueries(database, toQueries(MessagesSchema));
+  if (soFarSoGood) {
+    database.transaction();
+
+    QSqlQuery query(database);
+    query.prepare(
+      "INSERT INTO history (localContact, remoteContact, direction, message, time, read, status, utc) "
+      "VALUES (?, ?, ?, ?, '-1', ?, ?, ?)"
+    );
+
+    const QString localSipAddress = getLocalSipAddress();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+
+    for (int i = 0; soFarSoGood && i < mVolumes.chatRooms; ++i) {
+      const QString sipAddress = getPeerSipAddress(i);
+      qint64 timestamp = now - ONE_YEAR + random(0, ONE_YEAR / 2);
+
+      for (int j = 0; soFarSoGood && j < mVolumes.messagesPerChatRoom; ++j) {
+        bool isLast = j == mVolumes.messagesPerChatRoom - 1;
+        int direction = isLast || random(0, 1) ? MESSAGE_DIR_INCOMING : MESSAGE_DIR_OUTGOING;
+        timestamp += random(1, 600);
+
+        query.addBindValue(localSipAddress);
+        query.addBindValue(sipAddress);
+        query.addBindValue(direction);
+        query.addBindValue(QStringLiteral("Message %1 of conversation %2, sent by linphone-bench.").arg(j).arg(i));
+        query.addBindValue(isLast && i % UNREAD_CHAT_ROOM_MODULO == 0 ? 0 : 1);
+        query.addBindValue(MESSAGE_STATE_DELIVERED);
+        query.addBindValue(timestamp);
+        soFarSoGood = query.exec();
+      }
+    }
+
+    const QString busySipAddress = getBusySipAddress();
+    const qint64 busyStartTime = now - ONE_YEAR;
+    const int busyMessagesCount = mVolumes.busyConversation ? BUSY_CONVERSATION_MESSAGES_COUNT : 0;
+    for (int j = 0; soFarSoGood && j < busyMessagesCount; ++j) {
+      query.addBindValue(localSipAddress);
+      query.addBindValue(busySipAddress);
+      query.addBindValue(random(0, 1) ? MESSAGE_DIR_INCOMING : MESSAGE_DIR_OUTGOING);
+      query.addBindValue(QStringLiteral("Message %1 of the busy conversation.").arg(j));
+      query.addBindValue(1);
+      query.addBindValue(MESSAGE_STATE_DELIVERED);
+      query.addBindValue(busyStartTime + j * BUSY_CONVERSATION_MESSAGES_INTERVAL);
+      soFarSoGood = query.exec();
+    }
+
+    if (!soFarSoGood)
+      qWarning() << QStringLiteral("Unable to seed messages:") << query.lastError().text();
+
+    database.commit();
+  }
+
+  database.close();
+  database = QSqlDatabase();
+  QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
+
+  return soFarSoGood;
+}
+
+bool BenchmarkSeeder::seedCallLogs () {
+  QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", DB_CONNECTION_NAME);
+  database.setDatabaseName(::Utils::coreStringToAppString(Paths::getCallHistoryFilePath()));
+
+  bool soFarSoGood = execQueries(database, toQueries(CallLogsSchema));
+  if (soFarSoGood) {
+    database.transaction();
+
+    QSqlQuery query(database);
+    query.prepare(
+      "INSERT INTO call_history (caller, callee, direction, duration, start_time, connected_time, status, videoEnabled, quality) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, 0, -1)"
+    );
+
+    const QString localSipAddress = getLocalSipAddress();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+    const int peersCount = qMax(mVolumes.chatRooms, mVolumes.contacts);
+
+    for (int i = 0; soFarSoGood && i < mVolumes.callLogs; ++i) {
+      const QString sipAddress = getPeerSipAddress(random(0, qMax(peersCount - 1, 0)));
+      bool isIncoming = random(0, 1);
+      bool isMissed = isIncoming && random(0, 9) == 0;
+      qint64 startTime = now - random(0, ONE_YEAR);
+
+      query.addBindValue(isIncoming ? sipAddress : localSipAddress);
+      query.addBindValue(isIncoming ? localSipAddress : sipAddress);
+      query.addBindValue(isIncoming ? CALL_DIR_INCOMING : CALL_DIR_OUTGOING);
+      query.addBindValue(isMissed ? 0 : random(1, 3600));
+      query.addBindValue(startTime);
+      query.addBindValue(isMissed ? 0 : startTime);
+      query.addBindValue(isMissed ? CALL_STATUS_MISSED : CALL_STATUS_SUCCESS);
+      soFarSoGood = query.exec();
+    }
+
+    const QString busySipAddress = getBusySipAddress();
+    const qint64 busyStartTime = now - ONE_YEAR;
+    const int busyDuration = BUSY_CONVERSATION_MESSAGES_COUNT * BUSY_CONVERSATION_MESSAGES_INTERVAL;
+    const int busyCallLogsCount = mVolumes.busyConversation ? BUSY_CONVERSATION_CALL_LOGS_COUNT : 0;
+    for (int i = 0; soFarSoGood && i < busyCallLogsCount; ++i) {
+      bool isMissed = random(0, 9) == 0;
+      qint64 startTime = busyStartTime + random(0, busyDuration);
+
+      query.addBindValue(busySipAddress);
+      query.addBindValue(localSipAddress);
+      query.addBindValue(CALL_DIR_INCOMING);
+      query.addBindValue(isMissed ? 0 : random(1, 600));
+      query.addBindValue(startTime);
+      query.addBindValue(isMissed ? 0 : startTime);
+      query.addBindValue(isMissed ? CALL_STATUS_MISSED : CALL_STATUS_SUCCESS);
+      soFarSoGood = query.exec();
+    }
+
+    if (!soFarSoGood)
+      qWarning() << QStringLiteral("Unable to seed call logs:") << query.lastError().text();
+
+    database.commit();
+  }
+
+  database.close();
+  database = QSqlDatabase();
+  QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
+
+  return soFarSoGood;
+}
+
+// -----------------------------------------------------------------------------
+
+int BenchmarkSeeder::random (int min, int max) {
+  return uniform_int_distribution<int>(min, max)(mGenerator);
+}
+
+bool BenchmarkSeeder::execQueries (QSqlDatabase &database, const QStringList &queries) {
+  if (!database.open()) {
+    qWarning() << QStringLiteral("Unable to open `%1`:").arg(database.databaseName()) << database.lastError().text();
+    return false;
+  }
+
+  QSqlQuery query(database);
+  for (const auto &queryString : queries)
+    if (!query.exec(queryString)) {
+      qWarning() << QStringLiteral("Unable to exec `%1`:").arg(queryString) << query.lastError().text();
+      return false;
+    }
+
+  return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * BenchmarkSeeder.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef BENCHMARK_SEEDER_H_
+#define BENCHMARK_SEEDER_H_
+
+#include <random>
+
+#include <QStringList>
+
+// =============================================================================
+
+class QSqlDatabase;
+
+// Fills the friends, call logs and messages databases with synthetic data.
+// The databases are written directly, so no network or SIP server is used.
+class BenchmarkSeeder {
+public:
+  struct Volumes {
+    int contacts;
+    int chatRooms;
+    int messagesPerChatRoom;
+    int callLogs;
+    int uploadSize; // In megabytes, not seeded.
+    bool busyConversation; // One more conversation of 10k messages and 5k calls.
+  };
+
+  BenchmarkSeeder (const Volumes &volumes, quint32 seed);
+  ~BenchmarkSeeder () = default;
+
+  // Must be called before the linphone core creation.
+  bool seed ();
+
+  const Volumes &getVolumes () const {
+    return mVolumes;
+  }
+
+  // Sip address of the chat room at `index`. The first ones are linked to contacts.
+  QString getPeerSipAddress (int index) const;
+
+  // A contact name to simulate searches.
+  QString getSearchPattern () const;
+
+  // A chat room of 10k messages interleaved with 5k calls.
+  static QString getBusySipAddress ();
+
+  static QString getLocalSipAddress ();
+
+private:
+  bool seedFriends ();
+  bool seedMessages ();
+  bool seedCallLogs ();
+
+  int random (int min, int max);
+
+  static bool execQueries (QSqlDatabase &database, const QStringList &queries);
+
+  Volumes mVolumes;
+  std::mt19937 mGenerator;
+
+  QStringList mFirstNames;
+  QStringList mLastNames;
+};
+
+#endif // BENCHMARK_SEEDER_H_
@@ -0,0 +1,223 @@
+/*
+ * main.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <cstdio>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QtDebug>
+
+#include "../app/App.hpp"
+#include "../components/core/CoreManager.hpp"
+#include "../utils/Utils.hpp"
+
+#include "Benchmark.hpp"
+#include "BenchmarkCases.hpp"
+#include "BenchmarkSeeder.hpp"
+
+// Must be different of the app name. Used by `SingleApplication` and `Paths`.
+#define APPLICATION_NAME "linphone-bench"
+#define APPLICATION_VERSION "1.0"
+
+// Results format. Increment it if a field is changed.
+#define RESULTS_VERSION 1
+
+// No network: random ports and no stun.
+#define BENCH_CONFIG \
+  "[sip]\n" \
+  "sip_port=-1\n" \
+  "sip_tcp_port=-1\n" \
+  "sip_tls_port=-1\n" \
+  "register_only_when_network_is_up=1\n" \
+  "[net]\n" \
+  "stun_server=\n"
+
+#define DEFAULT_CONTACTS "1000"
+#define DEFAULT_CHAT_ROOMS "1000"
+#define DEFAULT_MESSAGES_PER_CHAT_ROOM "100"
+#define DEFAULT_CALL_LOGS "5000"
+#define DEFAULT_UPLOAD_SIZE "0"
+#define DEFAULT_ITERATIONS "5"
+#define DEFAULT_SEED "42"
+
+using namespace std;
+
+// =============================================================================
+
+inline int toNonNegativeInt (const QCommandLineParser &parser, const QString &option, bool &soFarSoGood) {
+  bool ok;
+  int value = parser.value(option).toInt(&ok);
+  if (!ok || value < 0) {
+    fprintf(stderr, "Invalid value for `--%s`.\n", option.toLocal8Bit().constData());
+    soFarSoGood = false;
+  }
+  return value;
+}
+
+inline bool writeFile (const QString &path, const QByteArray &data) {
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+// Waits until the core and the singleton models are created.
+inline qint64 startCore (App &app, const QString &configPath) {
+  QElapsedTimer timer;
+  timer.start();
+
+  app.initHeadlessContentApp(configPath);
+
+  QEventLoop loop;
+  QObject::connect(CoreManager::getInstance()->getHandlers().get(), &CoreHandlers::coreStarted, &loop, &QEventLoop::quit);
+  loop.exec();
+
+  return timer.nsecsElapsed();
+}
+
+// -----------------------------------------------------------------------------
+
+int main (int argc, char *argv[]) {
+  QStringList arguments;
+  for (int i = 0; i < argc; ++i)
+    arguments << QString::fromLocal8Bit(argv[i]);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Seeds synthetic linphone data and times the models.");
+  parser.addHelpOption();
+  parser.addOptions({
+    { "contacts", "Number of contacts.", "count", DEFAULT_CONTACTS },
+    { "chat-rooms", "Number of chat rooms.", "count", DEFAULT_CHAT_ROOMS },
+    { "messages-per-chat-room", "Number of messages of each chat room.", "count", DEFAULT_MESSAGES_PER_CHAT_ROOM },
+    { "call-logs", "Number of call logs.", "count", DEFAULT_CALL_LOGS },
+    { "upload-size", "Size in megabytes of the sent file, 0 to skip the upload case.", "size", DEFAULT_UPLOAD_SIZE },
+    { "busy-conversation", "Seed one more conversation of 10000 messages and 5000 calls, with its own chat cases." },
+    { "iterations", "Number of runs of each case.", "count", DEFAULT_ITERATIONS },
+    { "seed", "Seed of the generated data.", "seed", DEFAULT_SEED },
+    { "output", "Write the JSON results to this file instead of stdout.", "path" },
+    { "keep-data", "Do not remove the generated databases." }
+  });
+
+  if (!parser.parse(arguments)) {
+    fprintf(stderr, "%s\n", parser.errorText().toLocal8Bit().constData());
+    return EXIT_FAILURE;
+  }
+
+  if (parser.isSet("help")) {
+    printf("%s", parser.helpText().toLocal8Bit().constData());
+    return EXIT_SUCCESS;
+  }
+
+  bool soFarSoGood = true;
+
+  BenchmarkSeeder::Volumes volumes;
+  volumes.contacts = ::toNonNegativeInt(parser, "contacts", soFarSoGood);
+  volumes.chatRooms = ::toNonNegativeInt(parser, "chat-rooms", soFarSoGood);
+  volumes.messagesPerChatRoom = ::toNonNegativeInt(parser, "messages-per-chat-room", soFarSoGood);
+  volumes.callLogs = ::toNonNegativeInt(parser, "call-logs", soFarSoGood);
+  volumes.uploadSize = ::toNonNegativeInt(parser, "upload-size", soFarSoGood);
+  volumes.busyConversation = parser.isSet("busy-conversation");
+
+  int iterations = ::toNonNegativeInt(parser, "iterations", soFarSoGood);
+  int seed = ::toNonNegativeInt(parser, "seed", soFarSoGood);
+  if (!soFarSoGood || iterations == 0)
+    return EXIT_FAILURE;
+
+  // ---------------------------------------------------------------------------
+  // Headless environment. Data and config files are created in a temporary dir.
+  // ---------------------------------------------------------------------------
+
+  QTemporaryDir dataDir;
+  if (!dataDir.isValid()) {
+    fprintf(stderr, "Unable to create temporary dir.\n");
+    return EXIT_FAILURE;
+  }
+  dataDir.setAutoRemove(!parser.isSet("keep-data"));
+
+  qputenv("XDG_CONFIG_HOME", dataDir.filePath("config").toLocal8Bit());
+  qputenv("XDG_DATA_HOME", dataDir.filePath("data").toLocal8Bit());
+  qputenv("XDG_CACHE_HOME", dataDir.filePath("cache").toLocal8Bit());
+
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QCoreApplication::setApplicationName(APPLICATION_NAME);
+  QCoreApplication::setApplicationVersion(APPLICATION_VERSION);
+
+  // Bench options are not given to the app.
+  int appArgc = 1;
+  App app(appArgc, argv);
+
+  const QString configPath = dataDir.filePath("linphonerc");
+  if (!::writeFile(configPath, BENCH_CONFIG)) {
+    qWarning() << QStringLiteral("Unable to write config file: `%1`.").arg(configPath);
+    return EXIT_FAILURE;
+  }
+
+  BenchmarkSeeder seeder(volumes, static_cast<quint32>(seed));
+  if (!seeder.seed())
+    return EXIT_FAILURE;
+
+  // ---------------------------------------------------------------------------
+  // Run cases.
+  // ---------------------------------------------------------------------------
+
+  Benchmark benchmark(iterations);
+
+  // Includes the creation of the singleton models.
+  benchmark.addResult("core.start", QVector<qint64>() << ::startCore(app, configPath));
+
+  BenchmarkCases::run(benchmark, seeder);
+
+  QJsonObject parameters;
+  parameters["contacts"] = volumes.contacts;
+  parameters["chatRooms"] = volumes.chatRooms;
+  parameters["messagesPerChatRoom"] = volumes.messagesPerChatRoom;
+  parameters["callLogs"] = volumes.callLogs;
+  parameters["uploadSize"] = volumes.uploadSize;
+  parameters["busyConversation"] = volumes.busyConversation;
+  parameters["iterations"] = iterations;
+  parameters["seed"] = seed;
+
+  QJsonObject results;
+  results["version"] = RESULTS_VERSION;
+  results["linphoneVersion"] = ::Utils::coreStringToAppString(CoreManager::getInstance()->getCore()->getVersion());
+  results["qtVersion"] = qVersion();
+  results["parameters"] = parameters;
+  results["results"] = benchmark.getResults();
+
+  const QByteArray output = QJsonDocument(results).toJson();
+  if (parser.isSet("output")) {
+    if (!::writeFile(parser.value("output"), output)) {
+      qWarning() << QStringLiteral("Unable to write results: `%1`.").arg(parser.value("output"));
+      return EXIT_FAILURE;
+    }
+  } else
+    fwrite(output.constData(), 1, static_cast<size_t>(output.size()), stdout);
+
+  if (parser.isSet("keep-data"))
+    qInfo() << QStringLiteral("Data kept in: `%1`.").arg(dataDir.path());
+
+  return EXIT_SUCCESS;
+}
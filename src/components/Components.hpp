@@ -35,6 +35,7 @@
 #include "conference/ConferenceAddModel.hpp"
 #include "contacts/ContactsListProxyModel.hpp"
 #include "core/CoreManager.hpp"
+#include "message-search/MessageSearchModel.hpp"
 #include "presence/OwnPresenceModel.hpp"
 #include "settings/AccountSettingsModel.hpp"
 #include "sip-addresses/SipAddressesProxyModel.hpp"
@@ -21,15 +21,16 @@
  */
 
 #include <algorithm>
+#include <limits>
 
 #include <QDateTime>
 #include <QDesktopServices>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QFileInfo>
-#include <QImage>
+#include <QQueue>
 #include <QtDebug>
 #include <QTimer>
-#include <QUuid>
 
 #include "../../app/App.hpp"
 #include "../../app/paths/Paths.hpp"
@@ -37,13 +38,18 @@
 #include "../../utils/Utils.hpp"
 #include "../core/CoreManager.hpp"
 
+#include "ThumbnailGenerator.hpp"
+
 #include "ChatModel.hpp"
 
-#define THUMBNAIL_IMAGE_FILE_HEIGHT 100
-#define THUMBNAIL_IMAGE_FILE_WIDTH 100
+// In bytes. Part of a sent file mapped in memory.
+#define FILE_UPLOAD_MAP_SIZE 16777216
+
+// Number of messages fetched by `loadMoreEntries`.
+#define HISTORY_PAGE_SIZE 50
 
-// In Bytes.
-#define FILE_SIZE_LIMIT 524288000
+// In milliseconds. Duration of the progress samples used to compute the transfer speed.
+#define FILE_TRANSFER_SPEED_WINDOW 3000
 
 using namespace std;
 
@@ -62,51 +68,78 @@ inline bool fileWasDownloaded (const shared_ptr<linphone::ChatMessage> &message)
   return !path.isEmpty() && QFileInfo(path).isFile();
 }
 
-inline void fillThumbnailProperty (QVariantMap &dest, const shared_ptr<linphone::ChatMessage> &message) {
+// Aborted calls are not displayed.
+inline bool isDisplayedCall (const shared_ptr<linphone::CallLog> &callLog) {
+  linphone::CallStatus status = callLog->getStatus();
+  return status != linphone::CallStatusAborted && status != linphone::CallStatusEarlyAborted;
+}
+
+inline QString getThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
   QString fileId = ::getFileId(message);
-  if (!fileId.isEmpty() && !dest.contains("thumbnail"))
-    dest["thumbnail"] = QStringLiteral("image://%1/%2")
-      .arg(ThumbnailProvider::PROVIDER_ID).arg(fileId);
+  return fileId.isEmpty()
+    ? QString("")
+    : QStringLiteral("image://%1/%2").arg(ThumbnailProvider::PROVIDER_ID).arg(fileId);
 }
 
-inline void createThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
-  if (!message->getAppdata().empty())
-    return;
+inline void removeFileMessageThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
+  if (message && message->getFileTransferInformation()) {
+    CoreManager::getInstance()->getDownloadManager()->cancel(message);
+    message->cancelFileTransfer();
 
-  QString thumbnailPath = ::Utils::coreStringToAppString(message->getFileTransferFilepath());
+    const QString fileId = ::getFileId(message);
+    if (!fileId.isEmpty()) {
+      QString thumbnailPath = ::Utils::coreStringToAppString(Paths::getThumbnailsDirPath()) + fileId;
+      if (!QFile::remove(thumbnailPath))
+        qWarning() << QStringLiteral("Unable to remove `%1`.").arg(thumbnailPath);
+    }
+  }
+}
 
-  QImage image(thumbnailPath);
-  if (image.isNull())
-    return;
+// -----------------------------------------------------------------------------
 
-  QImage thumbnail = image.scaled(
-      THUMBNAIL_IMAGE_FILE_WIDTH, THUMBNAIL_IMAGE_FILE_HEIGHT,
-      Qt::KeepAspectRatio, Qt::SmoothTransformation
-    );
+// Serves the chunks of a sent file from a memory-mapped window.
+// So the memory use doesn't depend on the file size.
+class FileUpload {
+public:
+  FileUpload (const QString &path) : mFile(path) {}
 
-  QString uuid = QUuid::createUuid().toString();
-  QString fileId = QStringLiteral("%1.jpg").arg(uuid.mid(1, uuid.length() - 2));
+  ~FileUpload () {
+    if (mData)
+      mFile.unmap(mData);
+  }
 
-  if (!thumbnail.save(::Utils::coreStringToAppString(Paths::getThumbnailsDirPath()) + fileId, "jpg", 100)) {
-    qWarning() << QStringLiteral("Unable to create thumbnail of: `%1`.").arg(thumbnailPath);
-    return;
+  bool open () {
+    return mFile.open(QIODevice::ReadOnly);
   }
 
-  message->setAppdata(::Utils::appStringToCoreString(fileId));
-}
+  qint64 getSize () const {
+    return mFile.size();
+  }
 
-inline void removeFileMessageThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
-  if (message && message->getFileTransferInformation()) {
-    message->cancelFileTransfer();
+  // Returns `size` bytes at `offset`, valid until the next call.
+  const uchar *read (qint64 offset, qint64 size) {
+    if (!mData || offset < mDataOffset || offset + size > mDataOffset + mDataSize) {
+      if (mData)
+        mFile.unmap(mData);
 
-    string fileId = message->getAppdata();
-    if (!fileId.empty()) {
-      QString thumbnailPath = ::Utils::coreStringToAppString(Paths::getThumbnailsDirPath() + fileId);
-      if (!QFile::remove(thumbnailPath))
-        qWarning() << QStringLiteral("Unable to remove `%1`.").arg(thumbnailPath);
+      mDataOffset = offset;
+      mDataSize = qMin(qMax(size, static_cast<qint64>(FILE_UPLOAD_MAP_SIZE)), mFile.size() - offset);
+      mData = mFile.map(mDataOffset, mDataSize);
+
+      if (!mData)
+        return nullptr;
     }
+
+    return mData + (offset - mDataOffset);
   }
-}
+
+private:
+  QFile mFile;
+
+  uchar *mData = nullptr;
+  qint64 mDataOffset = 0;
+  qint64 mDataSize = 0;
+};
 
 // -----------------------------------------------------------------------------
 
@@ -114,77 +147,182 @@ class ChatModel::MessageHandlers : public linphone::ChatMessageListener {
   friend class ChatModel;
 
 public:
-  MessageHandlers (ChatModel *chatModel) : mChatModel(chatModel) {}
+  MessageHandlers (ChatModel *chatModel) : mChatModel(chatModel) {
+    mTimer.start();
+  }
 
   ~MessageHandlers () = default;
 
 private:
-  QList<ChatEntryData>::iterator findMessageEntry (const shared_ptr<linphone::ChatMessage> &message) {
-    return find_if(mChatModel->mEntries.begin(), mChatModel->mEntries.end(), [&message](const ChatEntryData &pair) {
-        return pair.second == message;
-      });
+  struct FileTransferProgress {
+    qint64 updateInterval;
+    qint64 lastUpdateTime;
+
+    // (Time, offset) samples of the speed window.
+    QQueue<QPair<qint64, quint64> > samples;
+  };
+
+  void signalDataChanged (int row, const QVector<int> &roles) {
+    emit mChatModel->dataChanged(mChatModel->index(row, 0), mChatModel->index(row, 0), roles);
   }
 
-  void signalDataChanged (const QList<ChatEntryData>::iterator &it) {
-    int row = static_cast<int>(distance(mChatModel->mEntries.begin(), it));
-    emit mChatModel->dataChanged(mChatModel->index(row, 0), mChatModel->index(row, 0));
+  bool startUpload (const shared_ptr<linphone::ChatMessage> &message, const QString &path) {
+    shared_ptr<FileUpload> upload = make_shared<FileUpload>(path);
+    if (!upload->open()) {
+      qWarning() << QStringLiteral("Unable to open file to send: `%1`.").arg(path);
+      return false;
+    }
+
+    mFileUploads[message.get()] = upload;
+    return true;
   }
 
+  // Called even if the chat model is destroyed: the upload continues.
   shared_ptr<linphone::Buffer> onFileTransferSend (
-    const shared_ptr<linphone::ChatMessage> &,
+    const shared_ptr<linphone::ChatMessage> &message,
     const shared_ptr<const linphone::Content> &,
-    size_t,
-    size_t
+    size_t offset,
+    size_t size
   ) override {
-    qWarning() << "`onFileTransferSend` called.";
-    return nullptr;
+    auto it = mFileUploads.find(message.get());
+    if (it == mFileUploads.end()) {
+      qWarning() << QStringLiteral("`onFileTransferSend` called without file to send.");
+      return nullptr;
+    }
+
+    FileUpload &upload = **it;
+
+    // An empty buffer ends the transfer.
+    qint64 n = qMin(static_cast<qint64>(size), upload.getSize() - static_cast<qint64>(offset));
+    if (n <= 0)
+      return linphone::Factory::get()->createBuffer();
+
+    const uchar *data = upload.read(static_cast<qint64>(offset), n);
+    if (!data) {
+      qWarning() << QStringLiteral("Unable to map file to send at offset %1.").arg(offset);
+      return nullptr;
+    }
+
+    return linphone::Factory::get()->createBufferFromData(data, static_cast<size_t>(n));
   }
 
   void onFileTransferProgressIndication (
     const shared_ptr<linphone::ChatMessage> &message,
     const shared_ptr<const linphone::Content> &,
     size_t offset,
-    size_t
+    size_t total
   ) override {
+    if (!message->isOutgoing())
+      CoreManager::getInstance()->getDownloadManager()->handleFileTransferProgress(message, offset);
+
     if (!mChatModel)
       return;
 
-    auto it = findMessageEntry(message);
-    if (it == mChatModel->mEntries.end())
+    int row = mChatModel->findMessageRow(message);
+    if (row < 0)
       return;
 
-    (*it).first["fileOffset"] = static_cast<quint64>(offset);
+    qint64 now = mTimer.elapsed();
 
-    signalDataChanged(it);
-  }
+    auto it = mFileTransfers.find(message.get());
+    if (it == mFileTransfers.end()) {
+      int rate = CoreManager::getInstance()->getSettingsModel()->getFileTransferProgressRate();
 
-  void onMsgStateChanged (const shared_ptr<linphone::ChatMessage> &message, linphone::ChatMessageState state) override {
-    if (!mChatModel)
-      return;
+      FileTransferProgress progress;
+      progress.updateInterval = rate > 0 ? 1000 / rate : 0;
+      progress.lastUpdateTime = -1;
+      it = mFileTransfers.insert(message.get(), progress);
+    }
+
+    FileTransferProgress &progress = *it;
 
-    auto it = findMessageEntry(message);
-    if (it == mChatModel->mEntries.end())
+    QQueue<QPair<qint64, quint64> > &samples = progress.samples;
+    samples.enqueue(qMakePair(now, static_cast<quint64>(offset)));
+    while (samples.count() > 2 && now - samples.head().first > FILE_TRANSFER_SPEED_WINDOW)
+      samples.dequeue();
+
+    // The last update is always delivered.
+    bool isFinished = total > 0 && offset >= total;
+    if (
+      !isFinished &&
+      progress.lastUpdateTime >= 0 &&
+      now - progress.lastUpdateTime < progress.updateInterval
+    )
       return;
 
-    // File message downloaded.
-    if (state == linphone::ChatMessageStateFileTransferDone && !message->isOutgoing()) {
-      ::createThumbnail(message);
-      ::fillThumbnailProperty((*it).first, message);
+    progress.lastUpdateTime = now;
+
+    // Bytes per second and remaining seconds. (-1 if unknown.)
+    qint64 speed = -1;
+    qint64 remainingTime = -1;
 
+    qint64 duration = samples.last().first - samples.head().first;
+    if (duration > 0) {
+      speed = static_cast<qint64>((samples.last().second - samples.head().second) * 1000 / duration);
+      if (speed > 0 && total > offset)
+        remainingTime = static_cast<qint64>((total - offset) / speed);
+    }
+
+    if (isFinished)
+      mFileTransfers.erase(it);
+
+    FileTransferState &state = mChatModel->mFileTransferStates[message.get()];
+    state.offset = static_cast<quint64>(offset);
+    state.speed = speed;
+    state.remainingTime = remainingTime;
+
+    signalDataChanged(row, { FileOffsetRole, FileSpeedRole, FileRemainingTimeRole });
+  }
+
+  void onMsgStateChanged (const shared_ptr<linphone::ChatMessage> &message, linphone::ChatMessageState state) override {
+    if (state != linphone::ChatMessageStateIdle && state != linphone::ChatMessageStateInProgress)
+      mFileUploads.remove(message.get());
+
+    if (state != linphone::ChatMessageStateInProgress)
+      mFileTransfers.remove(message.get());
+
+    // File message downloaded. The download can end after the chat model destruction.
+    const bool fileDownloaded = state == linphone::ChatMessageStateFileTransferDone && !message->isOutgoing();
+    if (fileDownloaded) {
       message->setAppdata(
         ::Utils::appStringToCoreString(::getFileId(message)) + ':' + message->getFileTransferFilepath()
       );
-      (*it).first["wasDownloaded"] = true;
+
+      // The entry is updated when the thumbnail is ready.
+      ThumbnailGenerator::getInstance()->createThumbnail(message);
 
       App::getInstance()->getNotifier()->notifyReceivedFileMessage(message);
     }
 
-    (*it).first["status"] = state;
+    if (!message->isOutgoing())
+      CoreManager::getInstance()->getDownloadManager()->handleMessageStateChanged(message, state);
+
+    if (!mChatModel)
+      return;
+
+    int row = mChatModel->findMessageRow(message);
+    if (row < 0)
+      return;
+
+    ChatEntryData &entry = mChatModel->mEntries[row];
+    if (fileDownloaded)
+      entry.flags |= WasDownloadedFlag;
 
-    signalDataChanged(it);
+    if (state != linphone::ChatMessageStateInProgress)
+      mChatModel->mFileTransferStates.remove(message.get());
+
+    entry.status = static_cast<qint8>(state);
+
+    signalDataChanged(row, { StatusRole, WasDownloadedRole });
   }
 
   ChatModel *mChatModel;
+
+  // Progress updates are coalesced to the `fileTransferProgressRate` setting.
+  QElapsedTimer mTimer;
+  QHash<const void *, FileTransferProgress> mFileTransfers;
+
+  QHash<const void *, shared_ptr<FileUpload> > mFileUploads;
 };
 
 // -----------------------------------------------------------------------------
@@ -196,9 +334,15 @@ ChatModel::ChatModel (QObject *parent) : QAbstractListModel(parent) {
   mMessageHandlers = make_shared<MessageHandlers>(this);
 
   core->getSipAddressesModel()->connectToChatModel(this);
+  core->getMessageSearchService()->connectToChatModel(this);
 
   QObject::connect(mCoreHandlers.get(), &CoreHandlers::messageReceived, this, &ChatModel::handleMessageReceived);
   QObject::connect(mCoreHandlers.get(), &CoreHandlers::callStateChanged, this, &ChatModel::handleCallStateChanged);
+
+  QObject::connect(
+    ThumbnailGenerator::getInstance(), &ThumbnailGenerator::thumbnailCreated,
+    this, &ChatModel::handleThumbnailCreated
+  );
 }
 
 ChatModel::~ChatModel () {
@@ -206,9 +350,25 @@ ChatModel::~ChatModel () {
 }
 
 QHash<int, QByteArray> ChatModel::roleNames () const {
+  return getRoleNames();
+}
+
+QHash<int, QByteArray> ChatModel::getRoleNames () {
   QHash<int, QByteArray> roles;
-  roles[Roles::ChatEntry] = "$chatEntry";
-  roles[Roles::SectionDate] = "$sectionDate";
+  roles[Roles::TypeRole] = "$type";
+  roles[Roles::TimestampRole] = "$timestamp";
+  roles[Roles::SectionDateRole] = "$sectionDate";
+  roles[Roles::IsOutgoingRole] = "$isOutgoing";
+  roles[Roles::StatusRole] = "$status";
+  roles[Roles::IsStartRole] = "$isStart";
+  roles[Roles::ContentRole] = "$content";
+  roles[Roles::FileNameRole] = "$fileName";
+  roles[Roles::FileSizeRole] = "$fileSize";
+  roles[Roles::FileOffsetRole] = "$fileOffset";
+  roles[Roles::FileSpeedRole] = "$fileSpeed";
+  roles[Roles::FileRemainingTimeRole] = "$fileRemainingTime";
+  roles[Roles::WasDownloadedRole] = "$wasDownloaded";
+  roles[Roles::ThumbnailRole] = "$thumbnail";
   return roles;
 }
 
@@ -222,11 +382,60 @@ QVariant ChatModel::data (const QModelIndex &index, int role) const {
   if (!index.isValid() || row < 0 || row >= mEntries.count())
     return QVariant();
 
+  const ChatEntryData &entry = mEntries[row];
+
+  switch (role) {
+    case Roles::TypeRole:
+      return entry.type;
+    case Roles::TimestampRole:
+      return QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(entry.timestamp) * 1000);
+    case Roles::SectionDateRole:
+      return QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(entry.timestamp) * 1000).date();
+    case Roles::IsOutgoingRole:
+      return !!(entry.flags & IsOutgoingFlag);
+    case Roles::StatusRole:
+      return entry.status;
+    case Roles::IsStartRole:
+      return !!(entry.flags & IsStartFlag);
+    default:
+      break;
+  }
+
+  if (entry.type != MessageEntry)
+    return QVariant();
+
+  // Message properties.
+  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
+
+  switch (role) {
+    case Roles::ContentRole:
+      return ::Utils::coreStringToAppString(message->getText());
+    case Roles::WasDownloadedRole:
+      return !!(entry.flags & WasDownloadedFlag);
+    case Roles::FileOffsetRole:
+      return mFileTransferStates.value(message.get(), { 0, -1, -1 }).offset;
+    case Roles::FileSpeedRole:
+      return mFileTransferStates.value(message.get(), { 0, -1, -1 }).speed;
+    case Roles::FileRemainingTimeRole:
+      return mFileTransferStates.value(message.get(), { 0, -1, -1 }).remainingTime;
+    default:
+      break;
+  }
+
+  // File properties.
+  shared_ptr<const linphone::Content> content = message->getFileTransferInformation();
+  if (!content)
+    return QVariant();
+
   switch (role) {
-    case Roles::ChatEntry:
-      return QVariant::fromValue(mEntries[row].first);
-    case Roles::SectionDate:
-      return QVariant::fromValue(mEntries[row].first["timestamp"].toDate());
+    case Roles::FileNameRole:
+      return ::Utils::coreStringToAppString(content->getName());
+    case Roles::FileSizeRole:
+      return static_cast<quint64>(content->getSize());
+    case Roles::ThumbnailRole:
+      return ::getThumbnail(message);
+    default:
+      break;
   }
 
   return QVariant();
@@ -246,9 +455,13 @@ bool ChatModel::removeRows (int row, int count, const QModelIndex &parent) {
 
   for (int i = 0; i < count; ++i) {
     removeEntry(mEntries[row]);
+    mMessageIndexes.remove(mEntries[row].linphonePtr.get());
+    mFileTransferStates.remove(mEntries[row].linphonePtr.get());
     mEntries.removeAt(row);
   }
 
+  shiftMessageRows(row, -count);
+
   endRemoveRows();
 
   if (mEntries.count() == 0)
@@ -266,6 +479,27 @@ QString ChatModel::getSipAddress () const {
   );
 }
 
+ChatModel::EntryType ChatModel::getEntryType (int row) const {
+  return static_cast<EntryType>(mEntries[row].type);
+}
+
+// Messages received while the chat was hidden are read now.
+void ChatModel::addDisplay () {
+  if (++mDisplaysCount != 1)
+    return;
+
+  if (mChatRoom && mChatRoom->getUnreadMessagesCount() > 0)
+    resetMessagesCount();
+
+  emit displayedChanged(true);
+}
+
+void ChatModel::removeDisplay () {
+  Q_ASSERT(mDisplaysCount > 0);
+  if (--mDisplaysCount == 0)
+    emit displayedChanged(false);
+}
+
 void ChatModel::setSipAddress (const QString &sipAddress) {
   if (sipAddress == getSipAddress() || sipAddress.isEmpty())
     return;
@@ -274,35 +508,168 @@ void ChatModel::setSipAddress (const QString &sipAddress) {
 
   // Invalid old sip address entries.
   mEntries.clear();
+  mMessageIndexes.clear();
+  mFileTransferStates.clear();
+  mFirstMessageIndex = 0;
+  mLoadedMessagesCount = 0;
+  mHistoryFullyLoaded = false;
+  mOldestMessageTime = 0;
 
   shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
 
   mChatRoom = core->getChatRoomFromUri(::Utils::appStringToCoreString(sipAddress));
 
-  if (mChatRoom->getUnreadMessagesCount() > 0)
+  if (isDisplayed() && mChatRoom->getUnreadMessagesCount() > 0)
     resetMessagesCount();
 
-  // Get messages.
-  for (auto &message : mChatRoom->getHistory(0)) {
-    QVariantMap map;
+  // Calls are inserted with the page of messages of the same period.
+  mPendingCallLogs.clear();
+  for (auto &callLog : core->getCallHistoryForAddress(mChatRoom->getPeerAddress()))
+    mPendingCallLogs << callLog;
 
-    fillMessageEntry(map, message);
+  sort(mPendingCallLogs.begin(), mPendingCallLogs.end(), [](
+    const shared_ptr<linphone::CallLog> &a,
+    const shared_ptr<linphone::CallLog> &b
+  ) {
+    return a->getStartDate() > b->getStartDate();
+  });
 
-    // Old workaround.
-    // It can exist messages with a not delivered status. It's a linphone core bug.
-    if (message->getState() == linphone::ChatMessageStateInProgress)
-      map["status"] = linphone::ChatMessageStateNotDelivered;
+  endResetModel();
 
-    mEntries << qMakePair(map, static_pointer_cast<void>(message));
+  // Get the last messages.
+  loadMoreEntries();
+
+  emit sipAddressChanged(sipAddress);
+}
+
+int ChatModel::loadMoreEntries () {
+  if (!mChatRoom || (mHistoryFullyLoaded && mPendingCallLogs.isEmpty()))
+    return 0;
+
+  int count = mEntries.count();
+
+  // 1. Get the previous page of messages. (From the oldest to the most recent.)
+  list<shared_ptr<linphone::ChatMessage> > messages;
+  if (!mHistoryFullyLoaded) {
+    messages = mChatRoom->getHistoryRange(mLoadedMessagesCount, mLoadedMessagesCount + HISTORY_PAGE_SIZE - 1);
+
+    int n = static_cast<int>(messages.size());
+    mLoadedMessagesCount += n;
+    mHistoryFullyLoaded = n < HISTORY_PAGE_SIZE;
+
+    if (n > 0)
+      mOldestMessageTime = messages.front()->getTime();
   }
 
-  // Get calls.
-  for (auto &callLog : core->getCallHistoryForAddress(mChatRoom->getPeerAddress()))
-    insertCall(callLog);
+  // 2. Get the calls of the same period. (From the oldest to the most recent.)
+  QList<shared_ptr<linphone::CallLog> > callLogs;
+  while (
+    !mPendingCallLogs.isEmpty() &&
+    (mHistoryFullyLoaded || mPendingCallLogs.first()->getStartDate() >= mOldestMessageTime)
+  ) {
+    shared_ptr<linphone::CallLog> callLog = mPendingCallLogs.takeFirst();
+    if (::isDisplayedCall(callLog))
+      callLogs.prepend(callLog);
+  }
 
-  endResetModel();
+  // The end of a call can be after the already loaded entries.
+  time_t newestTime = mEntries.isEmpty()
+    ? numeric_limits<time_t>::max()
+    : mEntries.first().timestamp;
+
+  QVector<QPair<time_t, shared_ptr<linphone::CallLog> > > callEnds;
+  QList<shared_ptr<linphone::CallLog> > lateCallEnds;
+  for (const auto &callLog : callLogs)
+    if (callLog->getStatus() == linphone::CallStatusSuccess) {
+      time_t time = callLog->getStartDate() + callLog->getDuration();
+      if (time > newestTime)
+        lateCallEnds << callLog;
+      else
+        callEnds << qMakePair(time, callLog);
+    }
 
-  emit sipAddressChanged(sipAddress);
+  stable_sort(callEnds.begin(), callEnds.end(), [](
+    const QPair<time_t, shared_ptr<linphone::CallLog> > &a,
+    const QPair<time_t, shared_ptr<linphone::CallLog> > &b
+  ) {
+    return a.first < b.first;
+  });
+
+  // 3. Merge the sorted messages, call starts and call ends in one pass.
+  // For equal times: call start, call end, then message.
+  QList<ChatEntryData> page;
+  page.reserve(static_cast<int>(messages.size()) + callLogs.count() + callEnds.count());
+
+  QVector<int> messageRows;
+  messageRows.reserve(static_cast<int>(messages.size()));
+
+  auto messageIt = messages.cbegin();
+  int callIndex = 0;
+  int callEndIndex = 0;
+
+  for (;;) {
+    EntryType type = GenericEntry;
+    bool isStart = false;
+    time_t time = 0;
+
+    if (callIndex < callLogs.count()) {
+      type = CallEntry;
+      isStart = true;
+      time = callLogs[callIndex]->getStartDate();
+    }
+
+    if (callEndIndex < callEnds.count() && (type == GenericEntry || callEnds[callEndIndex].first < time)) {
+      type = CallEntry;
+      isStart = false;
+      time = callEnds[callEndIndex].first;
+    }
+
+    if (messageIt != messages.cend() && (type == GenericEntry || (*messageIt)->getTime() < time))
+      type = MessageEntry;
+
+    ChatEntryData entry;
+
+    if (type == MessageEntry) {
+      const shared_ptr<linphone::ChatMessage> &message = *messageIt++;
+      fillMessageEntry(entry, message);
+
+      // Old workaround.
+      // It can exist messages with a not delivered status. It's a linphone core bug.
+      if (message->getState() == linphone::ChatMessageStateInProgress)
+        entry.status = static_cast<qint8>(linphone::ChatMessageStateNotDelivered);
+
+      messageRows << page.count();
+    } else if (type == CallEntry && isStart)
+      fillCallStartEntry(entry, callLogs[callIndex++]);
+    else if (type == CallEntry)
+      fillCallEndEntry(entry, callEnds[callEndIndex++].second);
+    else
+      break;
+
+    page << entry;
+  }
+
+  int n = page.count();
+  if (n > 0) {
+    beginInsertRows(QModelIndex(), 0, n - 1);
+
+    mEntries = page + mEntries;
+
+    mFirstMessageIndex -= n;
+    for (int row : messageRows)
+      mMessageIndexes[page[row].linphonePtr.get()] = mFirstMessageIndex + row;
+
+    endInsertRows();
+  }
+
+  // 4. Rare: calls started in this page and ended after the next entries.
+  for (const auto &callLog : lateCallEnds) {
+    ChatEntryData entry;
+    fillCallEndEntry(entry, callLog);
+    insertEntry(entry, n);
+  }
+
+  return mEntries.count() - count;
 }
 
 // -----------------------------------------------------------------------------
@@ -316,18 +683,71 @@ void ChatModel::removeEntry (int id) {
 }
 
 void ChatModel::removeAllEntries () {
+  if (!mChatRoom)
+    return;
+
   qInfo() << QStringLiteral("Removing all chat entries of: %1.").arg(getSipAddress());
 
-  beginResetModel();
+  // 1. Get the loaded file messages and the calls to remove.
+  // Not loaded messages are never read: they are removed by `deleteHistory`,
+  // their downloads are cancelled by sip address and their thumbnails are found by prefix.
+  QList<shared_ptr<linphone::ChatMessage> > fileMessages;
+  QList<shared_ptr<linphone::CallLog> > callLogs;
+
+  for (const auto &entry : mEntries) {
+    if (entry.type == EntryType::MessageEntry) {
+      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
+      if (message->getFileTransferInformation())
+        fileMessages << message;
+    } else if (entry.flags & IsStartFlag)
+      callLogs << static_pointer_cast<linphone::CallLog>(entry.linphonePtr);
+  }
+
+  for (const auto &callLog : mPendingCallLogs)
+    if (::isDisplayedCall(callLog))
+      callLogs << callLog;
 
-  for (auto &entry : mEntries)
-    removeEntry(entry);
+  // 2. Clear the view immediately.
+  beginResetModel();
 
   mEntries.clear();
+  mMessageIndexes.clear();
+  mFileTransferStates.clear();
+  mFirstMessageIndex = 0;
+  mLoadedMessagesCount = 0;
+  mHistoryFullyLoaded = true;
+  mPendingCallLogs.clear();
 
   endResetModel();
 
   emit allEntriesRemoved();
+
+  // 3. Remove from storage in one batch, once the view is updated.
+  shared_ptr<linphone::ChatRoom> chatRoom = mChatRoom;
+  const QString sipAddress = getSipAddress();
+  QTimer::singleShot(0, CoreManager::getInstance(), [chatRoom, sipAddress, fileMessages, callLogs] {
+    CoreManager::getInstance()->getDownloadManager()->cancel(sipAddress);
+
+    // Only a loaded message can be uploaded.
+    QStringList fileIds;
+    for (const auto &message : fileMessages) {
+      message->cancelFileTransfer();
+
+      const QString fileId = ::getFileId(message);
+      if (!fileId.isEmpty())
+        fileIds << fileId;
+    }
+
+    chatRoom->deleteHistory();
+
+    shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
+    for (const auto &callLog : callLogs)
+      core->removeCallLog(callLog);
+
+    qInfo() << QStringLiteral("Removed history and %1 calls of: %2.").arg(callLogs.count()).arg(sipAddress);
+
+    ThumbnailGenerator::getInstance()->removeThumbnails(sipAddress, fileIds);
+  });
 }
 
 // -----------------------------------------------------------------------------
@@ -355,18 +775,25 @@ void ChatModel::resendMessage (int id) {
   }
 
   const ChatEntryData entry = mEntries[id];
-  const QVariantMap map = entry.first;
 
-  if (map["type"] != EntryType::MessageEntry) {
+  if (entry.type != EntryType::MessageEntry) {
     qWarning() << QStringLiteral("Unable to resend entry %1. It's not a message.").arg(id);
     return;
   }
 
-  switch (map["status"].toInt()) {
+  switch (entry.status) {
     case MessageStatusFileTransferError:
     case MessageStatusNotDelivered: {
-      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.second);
+      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
       message->setListener(mMessageHandlers);
+
+      if (
+        message->getFileTransferInformation() &&
+        message->getFileTransferFilepath().empty() &&
+        !mMessageHandlers->startUpload(message, ::getDownloadPath(message))
+      )
+        return;
+
       message->resend();
 
       break;
@@ -385,9 +812,12 @@ void ChatModel::sendFileMessage (const QString &path) {
   if (!file.exists())
     return;
 
+  // In megabytes, 0 if unlimited.
+  qint64 sizeLimit = CoreManager::getInstance()->getSettingsModel()->getFileTransferSizeLimit();
+
   qint64 fileSize = file.size();
-  if (fileSize > FILE_SIZE_LIMIT) {
-    qWarning() << QStringLiteral("Unable to send file. (Size limit=%1)").arg(FILE_SIZE_LIMIT);
+  if (sizeLimit > 0 && fileSize > sizeLimit * 1024 * 1024) {
+    qWarning() << QStringLiteral("Unable to send file. (Size limit=%1MB)").arg(sizeLimit);
     return;
   }
 
@@ -399,10 +829,16 @@ void ChatModel::sendFileMessage (const QString &path) {
   content->setName(::Utils::appStringToCoreString(QFileInfo(file).fileName()));
 
   shared_ptr<linphone::ChatMessage> message = mChatRoom->createFileTransferMessage(content);
-  message->setFileTransferFilepath(::Utils::appStringToCoreString(path));
+
+  // No file transfer path: the file is served by `onFileTransferSend`.
+  // The path is kept in the app data to open the file and to create the thumbnail.
+  message->setAppdata(':' + ::Utils::appStringToCoreString(path));
   message->setListener(mMessageHandlers);
 
-  ::createThumbnail(message);
+  if (!mMessageHandlers->startUpload(message, path))
+    return;
+
+  ThumbnailGenerator::getInstance()->createThumbnail(message);
 
   insertMessageAtEnd(message);
   mChatRoom->sendChatMessage(message);
@@ -414,10 +850,10 @@ void ChatModel::sendFileMessage (const QString &path) {
 
 void ChatModel::downloadFile (int id) {
   const ChatEntryData entry = getFileMessageEntry(id);
-  if (!entry.second)
+  if (!entry.linphonePtr)
     return;
 
-  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.second);
+  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
 
   switch (message->getState()) {
     case MessageStatusDelivered:
@@ -431,32 +867,17 @@ void ChatModel::downloadFile (int id) {
       return;
   }
 
-  bool soFarSoGood;
-  const QString safeFilePath = ::Utils::getSafeFilePath(
-      QStringLiteral("%1%2")
-      .arg(CoreManager::getInstance()->getSettingsModel()->getDownloadFolder())
-      .arg(entry.first["fileName"].toString()),
-      &soFarSoGood
-    );
-
-  if (!soFarSoGood) {
-    qWarning() << QStringLiteral("Unable to create safe file path for: %1.").arg(id);
-    return;
-  }
-
-  message->setFileTransferFilepath(::Utils::appStringToCoreString(safeFilePath));
+  // The file path is set when the download is started.
   message->setListener(mMessageHandlers);
-
-  if (message->downloadFile() < 0)
-    qWarning() << QStringLiteral("Unable to download file of entry %1.").arg(id);
+  CoreManager::getInstance()->getDownloadManager()->download(message, getSipAddress());
 }
 
 void ChatModel::openFile (int id, bool showDirectory) {
   const ChatEntryData entry = getFileMessageEntry(id);
-  if (!entry.second)
+  if (!entry.linphonePtr)
     return;
 
-  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.second);
+  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
   if (!::fileWasDownloaded(message)) {
     downloadFile(id);
     return;
@@ -470,7 +891,7 @@ void ChatModel::openFile (int id, bool showDirectory) {
 
 bool ChatModel::fileWasDownloaded (int id) {
   const ChatEntryData entry = getFileMessageEntry(id);
-  return entry.second && ::fileWasDownloaded(static_pointer_cast<linphone::ChatMessage>(entry.second));
+  return entry.linphonePtr && ::fileWasDownloaded(static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr));
 }
 
 // -----------------------------------------------------------------------------
@@ -485,12 +906,12 @@ const ChatModel::ChatEntryData ChatModel::getFileMessageEntry (int id) {
   }
 
   const ChatEntryData entry = mEntries[id];
-  if (entry.first["type"] != EntryType::MessageEntry) {
+  if (entry.type != EntryType::MessageEntry) {
     qWarning() << QStringLiteral("Unable to download entry %1. It's not a message.").arg(id);
     return ChatEntryData();
   }
 
-  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.second);
+  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
   if (!message->getFileTransferInformation()) {
     qWarning() << QStringLiteral("Entry %1 is not a file message.").arg(id);
     return ChatEntryData();
@@ -501,65 +922,63 @@ const ChatModel::ChatEntryData ChatModel::getFileMessageEntry (int id) {
 
 // -----------------------------------------------------------------------------
 
-void ChatModel::fillMessageEntry (QVariantMap &dest, const shared_ptr<linphone::ChatMessage> &message) {
-  dest["type"] = EntryType::MessageEntry;
-  dest["timestamp"] = QDateTime::fromMSecsSinceEpoch(message->getTime() * 1000);
-  dest["content"] = ::Utils::coreStringToAppString(message->getText());
-  dest["isOutgoing"] = message->isOutgoing() || message->getState() == linphone::ChatMessageStateIdle;
-  dest["status"] = message->getState();
+void ChatModel::fillMessageEntry (ChatEntryData &dest, const shared_ptr<linphone::ChatMessage> &message) {
+  dest.linphonePtr = message;
+  dest.timestamp = message->getTime();
+  dest.type = EntryType::MessageEntry;
+  dest.status = static_cast<qint8>(message->getState());
+  dest.flags = 0;
 
-  shared_ptr<const linphone::Content> content = message->getFileTransferInformation();
-  if (content) {
-    dest["fileSize"] = static_cast<quint64>(content->getSize());
-    dest["fileName"] = ::Utils::coreStringToAppString(content->getName());
-    dest["wasDownloaded"] = ::fileWasDownloaded(message);
+  if (message->isOutgoing() || message->getState() == linphone::ChatMessageStateIdle)
+    dest.flags |= IsOutgoingFlag;
 
-    ::fillThumbnailProperty(dest, message);
-  }
+  // Checked once: it's a file system access.
+  if (message->getFileTransferInformation() && ::fileWasDownloaded(message))
+    dest.flags |= WasDownloadedFlag;
 }
 
-void ChatModel::fillCallStartEntry (QVariantMap &dest, const shared_ptr<linphone::CallLog> &callLog) {
-  QDateTime timestamp = QDateTime::fromMSecsSinceEpoch(callLog->getStartDate() * 1000);
+void ChatModel::fillCallStartEntry (ChatEntryData &dest, const shared_ptr<linphone::CallLog> &callLog) {
+  dest.linphonePtr = callLog;
+  dest.timestamp = callLog->getStartDate();
+  dest.type = EntryType::CallEntry;
+  dest.status = static_cast<qint8>(callLog->getStatus());
+  dest.flags = IsStartFlag;
 
-  dest["type"] = EntryType::CallEntry;
-  dest["timestamp"] = timestamp;
-  dest["isOutgoing"] = callLog->getDir() == linphone::CallDirOutgoing;
-  dest["status"] = callLog->getStatus();
-  dest["isStart"] = true;
+  if (callLog->getDir() == linphone::CallDirOutgoing)
+    dest.flags |= IsOutgoingFlag;
 }
 
-void ChatModel::fillCallEndEntry (QVariantMap &dest, const shared_ptr<linphone::CallLog> &callLog) {
-  QDateTime timestamp = QDateTime::fromMSecsSinceEpoch((callLog->getStartDate() + callLog->getDuration()) * 1000);
+void ChatModel::fillCallEndEntry (ChatEntryData &dest, const shared_ptr<linphone::CallLog> &callLog) {
+  fillCallStartEntry(dest, callLog);
 
-  dest["type"] = EntryType::CallEntry;
-  dest["timestamp"] = timestamp;
-  dest["isOutgoing"] = callLog->getDir() == linphone::CallDirOutgoing;
-  dest["status"] = callLog->getStatus();
-  dest["isStart"] = false;
+  dest.timestamp = callLog->getStartDate() + callLog->getDuration();
+  dest.flags &= ~IsStartFlag;
 }
 
 // -----------------------------------------------------------------------------
 
-void ChatModel::removeEntry (ChatEntryData &pair) {
-  int type = pair.first["type"].toInt();
+void ChatModel::removeEntry (ChatEntryData &entry) {
+  int type = entry.type;
 
   switch (type) {
     case ChatModel::MessageEntry: {
-      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(pair.second);
+      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
       ::removeFileMessageThumbnail(message);
+      emit messageRemoved(message);
       mChatRoom->deleteMessage(message);
+      --mLoadedMessagesCount;
       break;
     }
 
     case ChatModel::CallEntry: {
-      if (pair.first["status"].toInt() == linphone::CallStatusSuccess) {
+      if (entry.status == linphone::CallStatusSuccess) {
         // WARNING: Unable to remove symmetric call here. (start/end)
         // We are between `beginRemoveRows` and `endRemoveRows`.
         // A solution is to schedule a `removeEntry` call in the Qt main loop.
-        shared_ptr<void> linphonePtr = pair.second;
+        shared_ptr<void> linphonePtr = entry.linphonePtr;
         QTimer::singleShot(0, this, [this, linphonePtr]() {
-            auto it = find_if(mEntries.begin(), mEntries.end(), [linphonePtr](const ChatEntryData &pair) {
-                  return pair.second == linphonePtr;
+            auto it = find_if(mEntries.begin(), mEntries.end(), [linphonePtr](const ChatEntryData &entry) {
+                  return entry.linphonePtr == linphonePtr;
                 });
 
             if (it != mEntries.end())
@@ -567,7 +986,7 @@ void ChatModel::removeEntry (ChatEntryData &pair) {
           });
       }
 
-      CoreManager::getInstance()->getCore()->removeCallLog(static_pointer_cast<linphone::CallLog>(pair.second));
+      CoreManager::getInstance()->getCore()->removeCallLog(static_pointer_cast<linphone::CallLog>(entry.linphonePtr));
       break;
     }
 
@@ -576,62 +995,74 @@ void ChatModel::removeEntry (ChatEntryData &pair) {
   }
 }
 
-void ChatModel::insertCall (const shared_ptr<linphone::CallLog> &callLog) {
-  linphone::CallStatus status = callLog->getStatus();
-
-  switch (status) {
-    case linphone::CallStatusAborted:
-    case linphone::CallStatusEarlyAborted:
-      return; // Ignore aborted calls.
-
-    case linphone::CallStatusSuccess:
-    case linphone::CallStatusMissed:
-    case linphone::CallStatusDeclined:
-      break;
-  }
+int ChatModel::insertEntry (const ChatEntryData &entry, int firstRow) {
+  auto it = lower_bound(mEntries.begin() + firstRow, mEntries.end(), entry, [](const ChatEntryData &a, const ChatEntryData &b) {
+      return a.timestamp < b.timestamp;
+    });
 
-  auto insertEntry = [this](
-      const ChatEntryData &pair,
-      const QList<ChatEntryData>::iterator *start = NULL
-    ) {
-      auto it = lower_bound(start ? *start : mEntries.begin(), mEntries.end(), pair, [](const ChatEntryData &a, const ChatEntryData &b) {
-            return a.first["timestamp"] < b.first["timestamp"];
-          });
+  int row = static_cast<int>(distance(mEntries.begin(), it));
 
-      int row = static_cast<int>(distance(mEntries.begin(), it));
+  beginInsertRows(QModelIndex(), row, row);
+  mEntries.insert(it, entry);
+  shiftMessageRows(row + 1, 1);
+  endInsertRows();
 
-      beginInsertRows(QModelIndex(), row, row);
-      it = mEntries.insert(it, pair);
-      endInsertRows();
+  return row;
+}
 
-      return it;
-    };
+void ChatModel::insertCall (const shared_ptr<linphone::CallLog> &callLog) {
+  if (!::isDisplayedCall(callLog))
+    return;
 
   // Add start call.
-  QVariantMap start;
+  ChatEntryData start;
   fillCallStartEntry(start, callLog);
-  auto it = insertEntry(qMakePair(start, static_pointer_cast<void>(callLog)));
+  int row = insertEntry(start);
 
   // Add end call. (if necessary)
-  if (status == linphone::CallStatusSuccess) {
-    QVariantMap end;
+  if (callLog->getStatus() == linphone::CallStatusSuccess) {
+    ChatEntryData end;
     fillCallEndEntry(end, callLog);
-    insertEntry(qMakePair(end, static_pointer_cast<void>(callLog)), &it);
+    insertEntry(end, row + 1);
   }
 }
 
 void ChatModel::insertMessageAtEnd (const shared_ptr<linphone::ChatMessage> &message) {
   int row = mEntries.count();
 
+  // The message is stored in the history, it shifts the offset of the next page.
+  ++mLoadedMessagesCount;
+
   beginInsertRows(QModelIndex(), row, row);
 
-  QVariantMap map;
-  fillMessageEntry(map, message);
-  mEntries << qMakePair(map, static_pointer_cast<void>(message));
+  ChatEntryData entry;
+  fillMessageEntry(entry, message);
+  mEntries << entry;
+  mMessageIndexes[message.get()] = mFirstMessageIndex + row;
 
   endInsertRows();
 }
 
+int ChatModel::findMessageRow (const shared_ptr<linphone::ChatMessage> &message) const {
+  auto it = mMessageIndexes.constFind(message.get());
+  if (it == mMessageIndexes.cend())
+    return -1;
+
+  int row = *it - mFirstMessageIndex;
+  Q_ASSERT(row >= 0 && row < mEntries.count() && mEntries[row].linphonePtr == message);
+  return row;
+}
+
+// Must be called when `mEntries` is updated in the middle.
+// `row` is the first row to shift, after the update.
+void ChatModel::shiftMessageRows (int row, int delta) {
+  for (int i = row; i < mEntries.count(); ++i) {
+    auto it = mMessageIndexes.find(mEntries[i].linphonePtr.get());
+    if (it != mMessageIndexes.end())
+      *it += delta;
+  }
+}
+
 void ChatModel::resetMessagesCount () {
   mChatRoom->markAsRead();
   emit messagesCountReset();
@@ -647,10 +1078,19 @@ void ChatModel::handleCallStateChanged (const shared_ptr<linphone::Call> &call,
     insertCall(call->getCallLog());
 }
 
+void ChatModel::handleThumbnailCreated (const shared_ptr<linphone::ChatMessage> &message) {
+  int row = findMessageRow(message);
+  if (row < 0)
+    return;
+
+  emit dataChanged(index(row, 0), index(row, 0), { ThumbnailRole });
+}
+
 void ChatModel::handleMessageReceived (const shared_ptr<linphone::ChatMessage> &message) {
   if (mChatRoom == message->getChatRoom()) {
     insertMessageAtEnd(message);
-    resetMessagesCount();
+    if (isDisplayed())
+      resetMessagesCount();
 
     emit messageReceived(message);
   }
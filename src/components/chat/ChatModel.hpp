@@ -27,7 +27,8 @@
 #include <QAbstractListModel>
 
 // =============================================================================
-// Fetch all N messages of a ChatRoom.
+// Fetch the messages of a ChatRoom page by page, from the most recent.
+// Call logs are merged with the loaded pages.
 // =============================================================================
 
 class CoreHandlers;
@@ -40,11 +41,26 @@ class ChatModel : public QAbstractListModel {
   Q_PROPERTY(QString sipAddress READ getSipAddress WRITE setSipAddress NOTIFY sipAddressChanged);
 
 public:
+  // One role per property: a delegate binding only reads its property.
   enum Roles {
-    ChatEntry = Qt::DisplayRole,
-    SectionDate
+    TypeRole = Qt::UserRole,
+    TimestampRole,
+    SectionDateRole,
+    IsOutgoingRole,
+    StatusRole,
+    IsStartRole,
+    ContentRole,
+    FileNameRole,
+    FileSizeRole,
+    FileOffsetRole,
+    FileSpeedRole,
+    FileRemainingTimeRole,
+    WasDownloadedRole,
+    ThumbnailRole
   };
 
+  Q_ENUM(Roles);
+
   enum EntryType {
     GenericEntry,
     MessageEntry,
@@ -88,6 +104,21 @@ public:
   QString getSipAddress () const;
   void setSipAddress (const QString &sipAddress);
 
+  EntryType getEntryType (int row) const;
+
+  // Received messages are marked as read only if the chat is displayed.
+  bool isDisplayed () const {
+    return mDisplaysCount > 0;
+  }
+
+  void addDisplay ();
+  void removeDisplay ();
+
+  static QHash<int, QByteArray> getRoleNames ();
+
+  // Loads the previous page of history. Returns the number of inserted entries.
+  int loadMoreEntries ();
+
   void removeEntry (int id);
   void removeAllEntries ();
 
@@ -111,31 +142,80 @@ signals:
 
   void messageSent (const std::shared_ptr<linphone::ChatMessage> &message);
   void messageReceived (const std::shared_ptr<linphone::ChatMessage> &message);
+  void messageRemoved (const std::shared_ptr<linphone::ChatMessage> &message);
 
   void messagesCountReset ();
 
+  // Emitted when the first display is added or the last one removed.
+  void displayedChanged (bool displayed);
+
 private:
-  typedef QPair<QVariantMap, std::shared_ptr<void> > ChatEntryData;
+  enum EntryFlag {
+    IsOutgoingFlag = 0x1,
+    IsStartFlag = 0x2,
+    WasDownloadedFlag = 0x4
+  };
+
+  // The other properties of an entry are read from its linphone object.
+  struct ChatEntryData {
+    std::shared_ptr<void> linphonePtr; // Message or call log.
+    time_t timestamp;
+    qint8 type; // `EntryType`.
+    qint8 status; // `MessageStatus` or `CallStatus`.
+    quint8 flags;
+  };
+
+  // Set during a file transfer.
+  struct FileTransferState {
+    quint64 offset;
+    qint64 speed;
+    qint64 remainingTime;
+  };
 
   const ChatEntryData getFileMessageEntry (int id);
 
-  void fillMessageEntry (QVariantMap &dest, const std::shared_ptr<linphone::ChatMessage> &message);
-  void fillCallStartEntry (QVariantMap &dest, const std::shared_ptr<linphone::CallLog> &callLog);
-  void fillCallEndEntry (QVariantMap &dest, const std::shared_ptr<linphone::CallLog> &callLog);
+  void fillMessageEntry (ChatEntryData &dest, const std::shared_ptr<linphone::ChatMessage> &message);
+  void fillCallStartEntry (ChatEntryData &dest, const std::shared_ptr<linphone::CallLog> &callLog);
+  void fillCallEndEntry (ChatEntryData &dest, const std::shared_ptr<linphone::CallLog> &callLog);
 
-  void removeEntry (ChatEntryData &pair);
+  void removeEntry (ChatEntryData &entry);
+
+  // Inserts an entry after `firstRow`, sorted by timestamp. Returns its row.
+  int insertEntry (const ChatEntryData &entry, int firstRow = 0);
 
   void insertCall (const std::shared_ptr<linphone::CallLog> &callLog);
   void insertMessageAtEnd (const std::shared_ptr<linphone::ChatMessage> &message);
 
+  int findMessageRow (const std::shared_ptr<linphone::ChatMessage> &message) const;
+  void shiftMessageRows (int row, int delta);
+
   void resetMessagesCount ();
 
   void handleCallStateChanged (const std::shared_ptr<linphone::Call> &call, linphone::CallState state);
   void handleMessageReceived (const std::shared_ptr<linphone::ChatMessage> &message);
+  void handleThumbnailCreated (const std::shared_ptr<linphone::ChatMessage> &message);
 
   QList<ChatEntryData> mEntries;
   std::shared_ptr<linphone::ChatRoom> mChatRoom;
 
+  // Number of history messages in `mEntries`, used as offset of the next page.
+  int mLoadedMessagesCount = 0;
+  bool mHistoryFullyLoaded = false;
+  time_t mOldestMessageTime = 0;
+
+  // Message => index. The row of a message is `index - mFirstMessageIndex`,
+  // so a page prepended at the top doesn't require to update the other indexes.
+  QHash<const void *, int> mMessageIndexes;
+  int mFirstMessageIndex = 0;
+
+  QHash<const void *, FileTransferState> mFileTransferStates;
+
+  // Calls older than the loaded messages. Sorted by descending start date.
+  QList<std::shared_ptr<linphone::CallLog> > mPendingCallLogs;
+
+  // Number of views of this model.
+  int mDisplaysCount = 0;
+
   std::shared_ptr<CoreHandlers> mCoreHandlers;
   std::shared_ptr<MessageHandlers> mMessageHandlers;
 };
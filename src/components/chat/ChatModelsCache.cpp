@@ -0,0 +1,111 @@
+/*
+ * ChatModelsCache.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <QTimer>
+
+#include "../core/CoreManager.hpp"
+
+#include "ChatModel.hpp"
+
+#include "ChatModelsCache.hpp"
+
+// Max number of models which are not displayed.
+#define MAX_CACHED_CHAT_MODELS 10
+
+using namespace std;
+
+// =============================================================================
+
+ChatModelsCache::ChatModelsCache (QObject *parent) : QObject(parent) {
+  mEvictionTimer = new QTimer(this);
+  mEvictionTimer->setSingleShot(true);
+  mEvictionTimer->setInterval(0);
+  QObject::connect(mEvictionTimer, &QTimer::timeout, this, &ChatModelsCache::evict);
+
+  QObject::connect(
+    CoreManager::getInstance()->getSettingsModel(), &SettingsModel::chatModelsCacheMaxEntriesChanged,
+    this, &ChatModelsCache::evict
+  );
+}
+
+shared_ptr<ChatModel> ChatModelsCache::getChatModel (const QString &sipAddress) {
+  shared_ptr<ChatModel> chatModel = mChatModels.value(sipAddress);
+  if (chatModel) {
+    int index = mSipAddresses.indexOf(sipAddress);
+    if (index > 0)
+      mSipAddresses.move(index, 0);
+    return chatModel;
+  }
+
+  chatModel = make_shared<ChatModel>();
+  chatModel->setSipAddress(sipAddress);
+
+  ChatModel *model = chatModel.get();
+  QObject::connect(model, &ChatModel::displayedChanged, this, [this](bool displayed) {
+    if (!displayed)
+      scheduleEviction();
+  });
+  QObject::connect(model, &ChatModel::rowsInserted, this, [this, model] {
+    if (!model->isDisplayed())
+      scheduleEviction();
+  });
+
+  mChatModels.insert(sipAddress, chatModel);
+  mSipAddresses.prepend(sipAddress);
+
+  evict();
+
+  return chatModel;
+}
+
+// -----------------------------------------------------------------------------
+
+void ChatModelsCache::evict () {
+  // The loaded entries are the main part of the memory used by a model.
+  const int maxEntriesCount = CoreManager::getInstance()->getSettingsModel()->getChatModelsCacheMaxEntries();
+
+  int cachedCount = 0;
+  int entriesCount = 0;
+  for (auto it = mSipAddresses.begin(); it != mSipAddresses.end(); ) {
+    const shared_ptr<ChatModel> &chatModel = mChatModels[*it];
+    if (chatModel->isDisplayed()) {
+      ++it;
+      continue;
+    }
+
+    entriesCount += chatModel->rowCount();
+    if (++cachedCount > MAX_CACHED_CHAT_MODELS || entriesCount > maxEntriesCount) {
+      --cachedCount;
+      entriesCount -= chatModel->rowCount();
+
+      QObject::disconnect(chatModel.get(), nullptr, this, nullptr);
+      mChatModels.remove(*it);
+      it = mSipAddresses.erase(it);
+    } else
+      ++it;
+  }
+}
+
+void ChatModelsCache::scheduleEviction () {
+  if (!mEvictionTimer->isActive())
+    mEvictionTimer->start();
+}
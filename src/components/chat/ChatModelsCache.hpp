@@ -0,0 +1,71 @@
+/*
+ * ChatModelsCache.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef CHAT_MODELS_CACHE_H_
+#define CHAT_MODELS_CACHE_H_
+
+#include <memory>
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+// =============================================================================
+// Keeps the last used chat models alive, so going back to a recent chat
+// doesn't reload its history. Cached models are updated by the core handlers
+// like the displayed ones.
+// =============================================================================
+
+class QTimer;
+
+class ChatModel;
+
+class ChatModelsCache : public QObject {
+  Q_OBJECT;
+
+public:
+  ChatModelsCache (QObject *parent = Q_NULLPTR);
+  ~ChatModelsCache () = default;
+
+  // Returns the chat model of `sipAddress`, created if necessary.
+  std::shared_ptr<ChatModel> getChatModel (const QString &sipAddress);
+
+private:
+  // Removes the least recently used models which are not displayed,
+  // until the cache respects the limits.
+  void evict ();
+
+  // Called when a model is hidden or a hidden model grows.
+  // Deferred: the model can be the sender of the signal.
+  void scheduleEviction ();
+
+  // Keyed by the sip address given at creation, which can differ from
+  // `ChatModel::getSipAddress`.
+  QHash<QString, std::shared_ptr<ChatModel> > mChatModels;
+
+  // Most recently used first.
+  QStringList mSipAddresses;
+
+  QTimer *mEvictionTimer;
+};
+
+#endif // CHAT_MODELS_CACHE_H_
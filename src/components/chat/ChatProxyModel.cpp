@@ -20,77 +20,73 @@
  *      Author: Ronan Abhamon
  */
 
-#include "ChatProxyModel.hpp"
+#include <algorithm>
 
-using namespace std;
+#include "../core/CoreManager.hpp"
 
-// =============================================================================
+#include "ChatProxyModel.hpp"
 
-// Fetch the L last filtered chat entries.
-class ChatProxyModel::ChatModelFilter : public QSortFilterProxyModel {
-public:
-  ChatModelFilter (QObject *parent) : QSortFilterProxyModel(parent) {
-    setSourceModel(&mChatModel);
-  }
+// Number of entries added to the window by `loadMoreEntries`, if they are already loaded.
+#define ENTRIES_CHUNK_SIZE 50
 
-  ChatModel::EntryType getEntryTypeFilter () {
-    return mEntryTypeFilter;
-  }
-
-  void setEntryTypeFilter (ChatModel::EntryType type) {
-    mEntryTypeFilter = type;
-    invalidate();
-  }
+using namespace std;
 
-protected:
-  bool filterAcceptsRow (int sourceRow, const QModelIndex &) const override {
-    if (mEntryTypeFilter == ChatModel::EntryType::GenericEntry)
-      return true;
+// =============================================================================
 
-    QModelIndex index = sourceModel()->index(sourceRow, 0, QModelIndex());
-    const QVariantMap data = index.data().toMap();
+inline int lowerBound (const QList<int> &rows, int value) {
+  return static_cast<int>(distance(rows.cbegin(), lower_bound(rows.cbegin(), rows.cend(), value)));
+}
 
-    return data["type"].toInt() == mEntryTypeFilter;
-  }
+// Prepend or append if possible, in O(1).
+inline void insertSortedRows (QList<int> &rows, int position, const QList<int> &values) {
+  if (position == 0)
+    for (auto it = values.crbegin(); it != values.crend(); ++it)
+      rows.prepend(*it);
+  else if (position == rows.count())
+    rows.append(values);
+  else
+    for (int i = 0; i < values.count(); ++i)
+      rows.insert(position + i, values[i]);
+}
 
-private:
-  ChatModel mChatModel;
-  ChatModel::EntryType mEntryTypeFilter = ChatModel::EntryType::GenericEntry;
-};
+// -----------------------------------------------------------------------------
 
-// =============================================================================
+ChatProxyModel::ChatProxyModel (QObject *parent) : QAbstractListModel(parent) {}
 
-const int ChatProxyModel::ENTRIES_CHUNK_SIZE = 50;
+ChatProxyModel::~ChatProxyModel () {
+  if (mChatModel)
+    mChatModel->removeDisplay();
+}
 
-ChatProxyModel::ChatProxyModel (QObject *parent) : QSortFilterProxyModel(parent) {
-  mChatModelFilter = new ChatModelFilter(this);
+int ChatProxyModel::rowCount (const QModelIndex &) const {
+  return mWindowCount;
+}
 
-  setSourceModel(mChatModelFilter);
+QHash<int, QByteArray> ChatProxyModel::roleNames () const {
+  return ChatModel::getRoleNames();
+}
 
-  ChatModel *chat = static_cast<ChatModel *>(mChatModelFilter->sourceModel());
+QVariant ChatProxyModel::data (const QModelIndex &index, int role) const {
+  int row = index.row();
 
-  QObject::connect(chat, &ChatModel::messageReceived, this, [this](const shared_ptr<linphone::ChatMessage> &) {
-      mMaxDisplayedEntries++;
-    });
+  if (!index.isValid() || row < 0 || row >= mWindowCount)
+    return QVariant();
 
-  QObject::connect(chat, &ChatModel::messageSent, this, [this](const shared_ptr<linphone::ChatMessage> &) {
-      mMaxDisplayedEntries++;
-    });
+  return mChatModel->data(mChatModel->index(mapToSourceRow(row), 0), role);
 }
 
 // -----------------------------------------------------------------------------
 
 #define CREATE_PARENT_MODEL_FUNCTION_WITH_ID(METHOD) \
   void ChatProxyModel::METHOD(int id) { \
-    QModelIndex sourceIndex = mapToSource(index(id, 0)); \
-    static_cast<ChatModel *>(mChatModelFilter->sourceModel())->METHOD( \
-      mChatModelFilter->mapToSource(sourceIndex).row() \
-    ); \
+    if (id >= 0 && id < mWindowCount) \
+      mChatModel->METHOD(mapToSourceRow(id)); \
   }
 
 #define CREATE_PARENT_MODEL_FUNCTION_PARAM(METHOD, ARG_TYPE) \
   void ChatProxyModel::METHOD(ARG_TYPE value) { \
-    static_cast<ChatModel *>(mChatModelFilter->sourceModel())->METHOD(value); \
+    if (mChatModel) \
+      mChatModel->METHOD(value); \
   }
 
 CREATE_PARENT_MODEL_FUNCTION_PARAM(sendFileMessage, const QString &);
@@ -102,54 +98,266 @@ CREATE_PARENT_MODEL_FUNCTION_WITH_ID(openFileDirectory);
 CREATE_PARENT_MODEL_FUNCTION_WITH_ID(removeEntry);
 CREATE_PARENT_MODEL_FUNCTION_WITH_ID(resendMessage);
 
-#undef CREATE_PARENT_MODEL_FUNCTION
+#undef CREATE_PARENT_MODEL_FUNCTION_PARAM
 #undef CREATE_PARENT_MODEL_FUNCTION_WITH_ID
 
 // -----------------------------------------------------------------------------
 
 void ChatProxyModel::removeAllEntries () {
-  static_cast<ChatModel *>(mChatModelFilter->sourceModel())->removeAllEntries();
+  if (mChatModel)
+    mChatModel->removeAllEntries();
 }
 
 QString ChatProxyModel::getSipAddress () const {
-  return static_cast<ChatModel *>(mChatModelFilter->sourceModel())->getSipAddress();
+  return mChatModel ? mChatModel->getSipAddress() : QString("");
 }
 
 void ChatProxyModel::setSipAddress (const QString &sipAddress) {
-  static_cast<ChatModel *>(mChatModelFilter->sourceModel())->setSipAddress(
-    sipAddress
-  );
+  if (sipAddress == getSipAddress() || sipAddress.isEmpty())
+    return;
+
+  // The downloads of the visible chat are started first.
+  CoreManager::getInstance()->getDownloadManager()->setPrioritySipAddress(sipAddress);
+
+  beginResetModel();
+
+  if (mChatModel) {
+    QObject::disconnect(mChatModel.get(), nullptr, this, nullptr);
+    mChatModel->removeDisplay();
+  }
+
+  // A recent chat is already loaded.
+  mChatModel = CoreManager::getInstance()->getChatModelsCache()->getChatModel(sipAddress);
+  mChatModel->addDisplay();
+
+  ChatModel *chatModel = mChatModel.get();
+  QObject::connect(chatModel, &ChatModel::modelAboutToBeReset, this, [this] {
+    beginResetModel();
+  });
+  QObject::connect(chatModel, &ChatModel::modelReset, this, &ChatProxyModel::handleModelReset);
+  QObject::connect(chatModel, &ChatModel::rowsInserted, this, &ChatProxyModel::handleRowsInserted);
+  QObject::connect(chatModel, &ChatModel::rowsAboutToBeRemoved, this, &ChatProxyModel::handleRowsAboutToBeRemoved);
+  QObject::connect(chatModel, &ChatModel::rowsRemoved, this, &ChatProxyModel::handleRowsRemoved);
+  QObject::connect(chatModel, &ChatModel::dataChanged, this, &ChatProxyModel::handleDataChanged);
+
+  rebuildRows();
+  mWindowCount = qMin(getFilteredCount(), ENTRIES_CHUNK_SIZE);
+
+  endResetModel();
+
+  emit sipAddressChanged(sipAddress);
 }
 
 // -----------------------------------------------------------------------------
 
 void ChatProxyModel::loadMoreEntries () {
-  int count = rowCount();
-  int parentCount = mChatModelFilter->rowCount();
+  int count = mWindowCount;
+
+  int hiddenCount = getWindowStart();
+  if (hiddenCount > 0) {
+    // Already loaded: extend the window.
+    int n = qMin(hiddenCount, ENTRIES_CHUNK_SIZE);
+
+    beginInsertRows(QModelIndex(), 0, n - 1);
+    mWindowCount += n;
+    endInsertRows();
+  } else if (mChatModel) {
+    // With an entry type filter, a page can contain no displayed entry.
+    // The entries of the loaded pages are inserted in the window by `handleRowsInserted`.
+    int filteredCount = getFilteredCount();
+    while (getFilteredCount() == filteredCount && mChatModel->loadMoreEntries() > 0) {}
+  }
 
-  if (count < parentCount) {
-    // Do not increase `mMaxDisplayedEntries` if it's not necessary...
-    // Limit qml calls.
-    if (count == mMaxDisplayedEntries)
-      mMaxDisplayedEntries += ENTRIES_CHUNK_SIZE;
+  count = mWindowCount - count;
+  if (count > 0)
+    emit moreEntriesLoaded(count);
+}
 
-    invalidateFilter();
+void ChatProxyModel::setEntryTypeFilter (ChatModel::EntryType type) {
+  if (mEntryTypeFilter == type)
+    return;
 
-    count = rowCount() - count;
-    if (count > 0)
-      emit moreEntriesLoaded(count);
+  beginResetModel();
+  mEntryTypeFilter = type;
+  mWindowCount = qMin(getFilteredCount(), ENTRIES_CHUNK_SIZE);
+  endResetModel();
+
+  emit entryTypeFilterChanged(type);
+}
+
+// -----------------------------------------------------------------------------
+
+const QList<int> *ChatProxyModel::getFilteredRows () const {
+  switch (mEntryTypeFilter) {
+    case ChatModel::MessageEntry:
+      return &mMessageRows;
+    case ChatModel::CallEntry:
+      return &mCallRows;
+    default:
+      break;
   }
+
+  return nullptr;
 }
 
-void ChatProxyModel::setEntryTypeFilter (ChatModel::EntryType type) {
-  if (mChatModelFilter->getEntryTypeFilter() != type) {
-    mChatModelFilter->setEntryTypeFilter(type);
-    emit entryTypeFilterChanged(type);
+int ChatProxyModel::getFilteredCount () const {
+  const QList<int> *rows = getFilteredRows();
+  if (rows)
+    return rows->count();
+  return mChatModel ? mChatModel->rowCount() : 0;
+}
+
+int ChatProxyModel::getFilteredPosition (int sourceRow) const {
+  const QList<int> *rows = getFilteredRows();
+  return rows ? ::lowerBound(*rows, sourceRow - mRowsOffset) : sourceRow;
+}
+
+int ChatProxyModel::mapToSourceRow (int row) const {
+  int position = getWindowStart() + row;
+
+  const QList<int> *rows = getFilteredRows();
+  return rows ? (*rows)[position] + mRowsOffset : position;
+}
+
+// Returns -1 if the source row is not displayed.
+int ChatProxyModel::mapFromSourceRow (int sourceRow) const {
+  int position = getFilteredPosition(sourceRow);
+
+  const QList<int> *rows = getFilteredRows();
+  if (rows && (position >= rows->count() || (*rows)[position] + mRowsOffset != sourceRow))
+    return -1;
+
+  int row = position - getWindowStart();
+  return row >= 0 && row < mWindowCount ? row : -1;
+}
+
+// -----------------------------------------------------------------------------
+
+void ChatProxyModel::rebuildRows () {
+  mMessageRows.clear();
+  mCallRows.clear();
+  mRowsOffset = 0;
+
+  if (!mChatModel)
+    return;
+
+  for (int row = 0, count = mChatModel->rowCount(); row < count; ++row) {
+    ChatModel::EntryType type = mChatModel->getEntryType(row);
+    if (type == ChatModel::MessageEntry)
+      mMessageRows << row;
+    else if (type == ChatModel::CallEntry)
+      mCallRows << row;
   }
 }
 
+// Adds `delta` to the source rows greater or equal to `sourceRow`.
+void ChatProxyModel::shiftRows (int sourceRow, int delta) {
+  int messagesPosition = ::lowerBound(mMessageRows, sourceRow - mRowsOffset);
+  int callsPosition = ::lowerBound(mCallRows, sourceRow - mRowsOffset);
+
+  // All rows are shifted. (A page prepended by the source for example.)
+  if (messagesPosition == 0 && callsPosition == 0) {
+    mRowsOffset += delta;
+    return;
+  }
+
+  for (int i = messagesPosition; i < mMessageRows.count(); ++i)
+    mMessageRows[i] += delta;
+  for (int i = callsPosition; i < mCallRows.count(); ++i)
+    mCallRows[i] += delta;
+}
+
 // -----------------------------------------------------------------------------
 
-bool ChatProxyModel::filterAcceptsRow (int sourceRow, const QModelIndex &) const {
-  return mChatModelFilter->rowCount() - sourceRow <= mMaxDisplayedEntries;
+void ChatProxyModel::handleModelReset () {
+  rebuildRows();
+  mWindowCount = getFilteredCount();
+
+  endResetModel();
+}
+
+void ChatProxyModel::handleRowsInserted (const QModelIndex &, int first, int last) {
+  int count = last - first + 1;
+
+  // 1. Get the type of the new rows.
+  QList<int> messageRows;
+  QList<int> callRows;
+  for (int row = first; row <= last; ++row) {
+    ChatModel::EntryType type = mChatModel->getEntryType(row);
+    if (type == ChatModel::MessageEntry)
+      messageRows << row;
+    else if (type == ChatModel::CallEntry)
+      callRows << row;
+  }
+
+  // 2. New filtered rows at the window start or after are displayed.
+  // Rows inserted before the window are displayed by `loadMoreEntries`.
+  const QList<int> *rows = getFilteredRows();
+
+  int position = getFilteredPosition(first);
+  int n = count;
+  int filteredCount = mChatModel->rowCount() - count;
+  if (rows) {
+    n = rows == &mMessageRows ? messageRows.count() : callRows.count();
+    filteredCount = rows->count();
+  }
+
+  int windowStart = filteredCount - mWindowCount;
+  bool isDisplayed = n > 0 && position >= windowStart;
+  if (isDisplayed)
+    beginInsertRows(QModelIndex(), position - windowStart, position - windowStart + n - 1);
+
+  // 3. Update the rows of each type.
+  int messagesPosition = ::lowerBound(mMessageRows, first - mRowsOffset);
+  int callsPosition = ::lowerBound(mCallRows, first - mRowsOffset);
+
+  shiftRows(first, count);
+
+  for (int &row : messageRows)
+    row -= mRowsOffset;
+  for (int &row : callRows)
+    row -= mRowsOffset;
+
+  ::insertSortedRows(mMessageRows, messagesPosition, messageRows);
+  ::insertSortedRows(mCallRows, callsPosition, callRows);
+
+  if (isDisplayed) {
+    mWindowCount += n;
+    endInsertRows();
+  }
+}
+
+void ChatProxyModel::handleRowsAboutToBeRemoved (const QModelIndex &, int first, int last) {
+  int windowStart = getWindowStart();
+
+  int start = qMax(getFilteredPosition(first), windowStart);
+  int end = getFilteredPosition(last + 1);
+
+  mRemovedWindowRowsCount = qMax(end - start, 0);
+  if (mRemovedWindowRowsCount > 0)
+    beginRemoveRows(QModelIndex(), start - windowStart, end - 1 - windowStart);
+}
+
+void ChatProxyModel::handleRowsRemoved (const QModelIndex &, int first, int last) {
+  for (QList<int> *rows : { &mMessageRows, &mCallRows }) {
+    int start = ::lowerBound(*rows, first - mRowsOffset);
+    int end = ::lowerBound(*rows, last + 1 - mRowsOffset);
+    rows->erase(rows->begin() + start, rows->begin() + end);
+  }
+
+  shiftRows(last + 1, -(last - first + 1));
+
+  if (mRemovedWindowRowsCount > 0) {
+    mWindowCount -= mRemovedWindowRowsCount;
+    mRemovedWindowRowsCount = 0;
+    endRemoveRows();
+  }
+}
+
+void ChatProxyModel::handleDataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
+  for (int sourceRow = topLeft.row(); sourceRow <= bottomRight.row(); ++sourceRow) {
+    int row = mapFromSourceRow(sourceRow);
+    if (row >= 0)
+      emit dataChanged(index(row, 0), index(row, 0), roles);
+  }
 }
@@ -23,21 +23,28 @@
 #ifndef CHAT_PROXY_MODEL_H_
 #define CHAT_PROXY_MODEL_H_
 
-#include <QSortFilterProxyModel>
-
 #include "ChatModel.hpp"
 
+// =============================================================================
+// A window over the last entries of a `ChatModel`, filtered by entry type.
+// The rows of each entry type are indexed, so scrolling back or changing the
+// filter only costs the size of the window.
+// The chat models are shared by `ChatModelsCache`.
 // =============================================================================
 
-class ChatProxyModel : public QSortFilterProxyModel {
-  class ChatModelFilter;
-
+class ChatProxyModel : public QAbstractListModel {
   Q_OBJECT;
 
   Q_PROPERTY(QString sipAddress READ getSipAddress WRITE setSipAddress NOTIFY sipAddressChanged);
 
 public:
   ChatProxyModel (QObject *parent = Q_NULLPTR);
+  ~ChatProxyModel ();
+
+  int rowCount (const QModelIndex &index = QModelIndex()) const override;
+
+  QHash<int, QByteArray> roleNames () const override;
+  QVariant data (const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
   Q_INVOKABLE void loadMoreEntries ();
   Q_INVOKABLE void setEntryTypeFilter (ChatModel::EntryType type);
@@ -60,17 +67,50 @@ signals:
 
   void entryTypeFilterChanged (ChatModel::EntryType type);
 
-protected:
-  bool filterAcceptsRow (int sourceRow, const QModelIndex &sourceParent) const override;
-
 private:
   QString getSipAddress () const;
   void setSipAddress (const QString &sipAddress);
 
-  ChatModelFilter *mChatModelFilter;
-  int mMaxDisplayedEntries = ENTRIES_CHUNK_SIZE;
+  // Source rows accepted by the entry type filter. Null if all rows are accepted.
+  const QList<int> *getFilteredRows () const;
+
+  // Number of source rows accepted by the entry type filter.
+  int getFilteredCount () const;
+
+  // Position in the filtered rows of the first source row greater or equal to `sourceRow`.
+  int getFilteredPosition (int sourceRow) const;
+
+  int getWindowStart () const {
+    return getFilteredCount() - mWindowCount;
+  }
+
+  int mapToSourceRow (int row) const;
+  int mapFromSourceRow (int sourceRow) const;
+
+  void rebuildRows ();
+  void shiftRows (int sourceRow, int delta);
+
+  void handleModelReset ();
+  void handleRowsInserted (const QModelIndex &parent, int first, int last);
+  void handleRowsAboutToBeRemoved (const QModelIndex &parent, int first, int last);
+  void handleRowsRemoved (const QModelIndex &parent, int first, int last);
+  void handleDataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+
+  std::shared_ptr<ChatModel> mChatModel;
+  ChatModel::EntryType mEntryTypeFilter = ChatModel::GenericEntry;
+
+  // Source rows of each entry type, in ascending order.
+  // A source row is `value + mRowsOffset`: a page prepended by the source
+  // only updates the offset.
+  QList<int> mMessageRows;
+  QList<int> mCallRows;
+  int mRowsOffset = 0;
+
+  // The last `mWindowCount` filtered rows are exposed.
+  int mWindowCount = 0;
 
-  static const int ENTRIES_CHUNK_SIZE;
+  // Set between `rowsAboutToBeRemoved` and `rowsRemoved`.
+  int mRemovedWindowRowsCount = 0;
 };
 
 #endif // CHAT_PROXY_MODEL_H_
@@ -0,0 +1,200 @@
+/*
+ * ThumbnailGenerator.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QtConcurrent>
+#include <QtDebug>
+#include <QUuid>
+
+#include "../../app/paths/Paths.hpp"
+#include "../../utils/Utils.hpp"
+
+#include "ThumbnailGenerator.hpp"
+
+#define THUMBNAIL_IMAGE_FILE_HEIGHT 100
+#define THUMBNAIL_IMAGE_FILE_WIDTH 100
+
+#define THUMBNAIL_IMAGE_FILE_QUALITY 80
+
+// Decoding is memory expensive, limit the number of images decoded at the same time.
+#define MAX_THREADS_COUNT 2
+
+// Number of hexadecimal characters of the chat prefix of a file id.
+#define FILE_ID_PREFIX_LENGTH 16
+
+using namespace std;
+
+// =============================================================================
+
+ThumbnailGenerator *ThumbnailGenerator::mInstance = nullptr;
+
+// App data of file messages: `<fileId>[:<downloadPath>]`.
+// File ids: `<chatPrefix>-<uuid>.jpg`. Ids created before the prefix are only a uuid.
+
+inline QString getFileId (const shared_ptr<linphone::ChatMessage> &message) {
+  return ::Utils::coreStringToAppString(message->getAppdata()).section(':', 0, 0);
+}
+
+inline QString getDownloadPath (const shared_ptr<linphone::ChatMessage> &message) {
+  return ::Utils::coreStringToAppString(message->getAppdata()).section(':', 1);
+}
+
+inline void setFileId (const shared_ptr<linphone::ChatMessage> &message, const QString &fileId) {
+  const QString downloadPath = ::getDownloadPath(message);
+  message->setAppdata(::Utils::appStringToCoreString(
+    downloadPath.isEmpty() ? fileId : QStringLiteral("%1:%2").arg(fileId).arg(downloadPath)
+  ));
+}
+
+inline QString getFileIdPrefix (const shared_ptr<linphone::ChatMessage> &message) {
+  return ThumbnailGenerator::getFileIdPrefix(
+    ::Utils::coreStringToAppString(message->getChatRoom()->getPeerAddress()->asStringUriOnly())
+  );
+}
+
+inline QString createFileId (const QString &prefix) {
+  QString uuid = QUuid::createUuid().toString();
+  return QStringLiteral("%1-%2.jpg").arg(prefix).arg(uuid.mid(1, uuid.length() - 2));
+}
+
+// Called in a worker thread. Returns an empty id on failure.
+inline QString createThumbnailFile (const QString &imagePath, const QString &thumbnailsPath, const QString &prefix) {
+  QImageReader reader(imagePath);
+  reader.setAutoTransform(true);
+
+  // Decode at the thumbnail size, if possible directly. (For example with jpeg.)
+  QSize size = reader.size();
+  if (!size.isValid())
+    return QString("");
+
+  if (size.width() > THUMBNAIL_IMAGE_FILE_WIDTH || size.height() > THUMBNAIL_IMAGE_FILE_HEIGHT)
+    reader.setScaledSize(size.scaled(THUMBNAIL_IMAGE_FILE_WIDTH, THUMBNAIL_IMAGE_FILE_HEIGHT, Qt::KeepAspectRatio));
+
+  QImage thumbnail = reader.read();
+  if (thumbnail.isNull())
+    return QString("");
+
+  const QString fileId = ::createFileId(prefix);
+  if (!thumbnail.save(thumbnailsPath + fileId, "jpg", THUMBNAIL_IMAGE_FILE_QUALITY))
+    return QString("");
+
+  return fileId;
+}
+
+// -----------------------------------------------------------------------------
+
+ThumbnailGenerator::ThumbnailGenerator (QObject *parent) : QObject(parent) {
+  mThumbnailsPath = ::Utils::coreStringToAppString(Paths::getThumbnailsDirPath());
+  mThreadPool.setMaxThreadCount(MAX_THREADS_COUNT);
+}
+
+ThumbnailGenerator *ThumbnailGenerator::getInstance () {
+  if (!mInstance)
+    mInstance = new ThumbnailGenerator(QCoreApplication::instance());
+  return mInstance;
+}
+
+// -----------------------------------------------------------------------------
+
+void ThumbnailGenerator::createThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
+  if (!::getFileId(message).isEmpty())
+    return;
+
+  // A sent file has no file transfer path, it's in the app data.
+  QString imagePath = ::Utils::coreStringToAppString(message->getFileTransferFilepath());
+  if (imagePath.isEmpty())
+    imagePath = ::getDownloadPath(message);
+  if (imagePath.isEmpty())
+    return;
+
+  auto it = mPendingMessages.find(imagePath);
+  if (it != mPendingMessages.end()) {
+    if (!it->contains(message))
+      it->append(message);
+    return;
+  }
+
+  mPendingMessages[imagePath] << message;
+
+  QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+  QObject::connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, imagePath] {
+    handleThumbnailCreated(imagePath, watcher->result());
+    watcher->deleteLater();
+  });
+  watcher->setFuture(QtConcurrent::run(&mThreadPool, ::createThumbnailFile, imagePath, mThumbnailsPath, ::getFileIdPrefix(message)));
+}
+
+void ThumbnailGenerator::removeThumbnails (const QString &sipAddress, const QStringList &fileIds) {
+  const QString thumbnailsPath = mThumbnailsPath;
+  const QString prefix = getFileIdPrefix(sipAddress);
+
+  QtConcurrent::run(&mThreadPool, [thumbnailsPath, prefix, fileIds] {
+    QDir dir(thumbnailsPath);
+    QStringList paths = dir.entryList(QStringList() << prefix + "-*", QDir::Files);
+    for (const QString &fileId : fileIds)
+      if (!fileId.startsWith(prefix))
+        paths << fileId;
+
+    for (const QString &path : paths)
+      if (!dir.remove(path))
+        qWarning() << QStringLiteral("Unable to remove `%1`.").arg(thumbnailsPath + path);
+  });
+}
+
+QString ThumbnailGenerator::getFileIdPrefix (const QString &sipAddress) {
+  return QString::fromLatin1(
+    QCryptographicHash::hash(sipAddress.toUtf8(), QCryptographicHash::Sha1).toHex().left(FILE_ID_PREFIX_LENGTH)
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+void ThumbnailGenerator::handleThumbnailCreated (const QString &imagePath, const QString &fileId) {
+  const QList<shared_ptr<linphone::ChatMessage> > messages = mPendingMessages.take(imagePath);
+
+  if (fileId.isEmpty()) {
+    qInfo() << QStringLiteral("No thumbnail created for: `%1`.").arg(imagePath);
+    return;
+  }
+
+  // Each message owns its thumbnail file: it's removed with the message.
+  for (int i = 0; i < messages.count(); ++i) {
+    const shared_ptr<linphone::ChatMessage> &message = messages[i];
+
+    QString messageFileId = fileId;
+    if (i > 0) {
+      messageFileId = ::createFileId(::getFileIdPrefix(message));
+      if (!QFile::copy(mThumbnailsPath + fileId, mThumbnailsPath + messageFileId)) {
+        qWarning() << QStringLiteral("Unable to copy thumbnail of: `%1`.").arg(imagePath);
+        continue;
+      }
+    }
+
+    ::setFileId(message, messageFileId);
+    emit thumbnailCreated(message);
+  }
+}
@@ -0,0 +1,73 @@
+/*
+ * ThumbnailGenerator.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef THUMBNAIL_GENERATOR_H_
+#define THUMBNAIL_GENERATOR_H_
+
+#include <linphone++/linphone.hh>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+// =============================================================================
+// Creates the thumbnails of file messages in worker threads.
+// =============================================================================
+
+class ThumbnailGenerator : public QObject {
+  Q_OBJECT;
+
+public:
+  ~ThumbnailGenerator () = default;
+
+  // Does nothing if the message has already a thumbnail.
+  // Requests on a file which is being processed are merged.
+  void createThumbnail (const std::shared_ptr<linphone::ChatMessage> &message);
+
+  // Removes in a worker thread the thumbnails of a chat, without reading its history.
+  // `fileIds` are the known ids, it's only needed for the ids created without chat prefix.
+  void removeThumbnails (const QString &sipAddress, const QStringList &fileIds);
+
+  // Common prefix of the file ids of a chat.
+  static QString getFileIdPrefix (const QString &sipAddress);
+
+  static ThumbnailGenerator *getInstance ();
+
+signals:
+  // Emitted in the GUI thread, once the message app data is updated.
+  void thumbnailCreated (const std::shared_ptr<linphone::ChatMessage> &message);
+
+private:
+  ThumbnailGenerator (QObject *parent = Q_NULLPTR);
+
+  void handleThumbnailCreated (const QString &imagePath, const QString &fileId);
+
+  QString mThumbnailsPath;
+  QThreadPool mThreadPool;
+
+  // Messages waiting for the thumbnail of a file.
+  QHash<QString, QList<std::shared_ptr<linphone::ChatMessage> > > mPendingMessages;
+
+  static ThumbnailGenerator *mInstance;
+};
+
+#endif // THUMBNAIL_GENERATOR_H_
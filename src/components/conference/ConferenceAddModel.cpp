@@ -180,11 +180,11 @@ void ConferenceHelperModel::ConferenceAddModel::handleDataChanged (
 
   int limit = bottomRight.row();
   for (int row = topLeft.row(); row <= limit; ++row) {
-    const QVariantMap map = sipAddressesModel->data(sipAddressesModel->index(row, 0)).toMap();
+    const QModelIndex sourceIndex = sipAddressesModel->index(row, 0);
 
-    auto it = mSipAddresses.find(map["sipAddress"].toString());
+    auto it = mSipAddresses.find(sourceIndex.data(SipAddressesModel::SipAddressRole).toString());
     if (it != mSipAddresses.end()) {
-      (*it)["contact"] = map.value("contact");
+      (*it)["contact"] = sourceIndex.data(SipAddressesModel::ContactRole);
 
       int row = mRefs.indexOf(&(*it));
       Q_ASSERT(row != -1);
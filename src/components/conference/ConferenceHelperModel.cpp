@@ -68,19 +68,17 @@ void ConferenceHelperModel::setFilter (const QString &pattern) {
 
 bool ConferenceHelperModel::filterAcceptsRow (int sourceRow, const QModelIndex &sourceParent) const {
   const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-  const QVariantMap data = index.data().toMap();
-
-  return !mConferenceAddModel->contains(data["sipAddress"].toString());
+  return !mConferenceAddModel->contains(index.data(SipAddressesModel::SipAddressRole).toString());
 }
 
 // -----------------------------------------------------------------------------
 
 bool ConferenceHelperModel::lessThan (const QModelIndex &left, const QModelIndex &right) const {
   shared_ptr<linphone::Call> callA = mCore->findCallFromUri(
-      ::Utils::appStringToCoreString(left.data().toMap()["sipAddress"].toString())
+      ::Utils::appStringToCoreString(left.data(SipAddressesModel::SipAddressRole).toString())
     );
   shared_ptr<linphone::Call> callB = mCore->findCallFromUri(
-      ::Utils::appStringToCoreString(right.data().toMap()["sipAddress"].toString())
+      ::Utils::appStringToCoreString(right.data(SipAddressesModel::SipAddressRole).toString())
     );
 
   return callA && !callB;
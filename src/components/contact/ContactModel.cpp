@@ -34,7 +34,6 @@ ContactModel::ContactModel (QObject *parent, shared_ptr<linphone::Friend> linpho
   Q_ASSERT(linphoneFriend != nullptr);
 
   mLinphoneFriend = linphoneFriend;
-  mLinphoneFriend->setData("contact-model", *this);
 
   setVcardModelInternal(new VcardModel(linphoneFriend->getVcard()));
 }
@@ -45,7 +44,6 @@ ContactModel::ContactModel (QObject *parent, VcardModel *vcardModel) : QObject(p
   Q_ASSERT(!vcardModel->mIsReadOnly);
 
   mLinphoneFriend = linphone::Friend::newFromVcard(vcardModel->mVcard);
-  mLinphoneFriend->setData("contact-model", *this);
 
   qInfo() << QStringLiteral("Create contact from vcard:") << this << vcardModel;
   setVcardModelInternal(vcardModel);
@@ -21,13 +21,12 @@
  */
 
 #include <belcard/belcard.hpp>
-#include <QFileInfo>
+#include <QFile>
 #include <QImageReader>
 #include <QtDebug>
 #include <QUuid>
 
 #include "../../app/App.hpp"
-#include "../../app/paths/Paths.hpp"
 #include "../../app/providers/AvatarProvider.hpp"
 #include "../../utils/Utils.hpp"
 #include "../core/CoreManager.hpp"
@@ -77,17 +76,13 @@ static void removeBelcardPhoto (const shared_ptr<belcard::BelCard> &belcard, boo
   }
 
   for (const auto photo : photos) {
-    QString imagePath(
-      ::Utils::coreStringToAppString(
-        Paths::getAvatarsDirPath() + photo->getValue().substr(sizeof(VCARD_SCHEME) - 1)
-      )
-    );
+    QString fileId(::Utils::coreStringToAppString(photo->getValue().substr(sizeof(VCARD_SCHEME) - 1)));
 
     if (!cleanPathsOnly) {
-      if (!QFile::remove(imagePath))
-        qWarning() << QStringLiteral("Unable to remove `%1`.").arg(imagePath);
+      if (!AvatarProvider::removeAvatar(fileId))
+        qWarning() << QStringLiteral("Unable to remove avatar `%1`.").arg(fileId);
       else
-        qInfo() << QStringLiteral("Remove `%1`.").arg(imagePath);
+        qInfo() << QStringLiteral("Remove avatar `%1`.").arg(fileId);
     }
 
     belcard->removePhoto(photo);
@@ -152,31 +147,25 @@ bool VcardModel::setAvatar (const QString &path) {
 
   shared_ptr<belcard::BelCard> belcard = mVcard->getVcard();
   QString fileId;
-  QFile file;
+  bool isNewFile = false;
 
-  // 1. Try to copy photo in avatars folder if it's a right path file and
-  // not a application path like `image:`.
+  // 1. Try to save the normalized sizes of the photo in avatars folder if
+  // it's a right path file and not a application path like `image:`.
   if (!path.isEmpty()) {
     if (path.startsWith("image:"))
       fileId = ::getFileIdFromAppPath(path);
     else {
-      file.setFileName(path);
-
-      if (!file.exists() || QImageReader::imageFormat(path).size() == 0)
+      if (!QFile::exists(path) || QImageReader::imageFormat(path).size() == 0)
         return false;
 
-      QFileInfo info(file);
       QString uuid = QUuid::createUuid().toString();
-      fileId = QStringLiteral("%1.%2")
-        .arg(uuid.mid(1, uuid.length() - 2)) // Remove `{}`.
-        .arg(info.suffix());
-
-      QString dest = ::Utils::coreStringToAppString(Paths::getAvatarsDirPath()) + fileId;
+      fileId = QStringLiteral("%1.png").arg(uuid.mid(1, uuid.length() - 2)); // Remove `{}`.
 
-      if (!file.copy(dest))
+      if (!AvatarProvider::createAvatar(path, fileId))
         return false;
+      isNewFile = true;
 
-      qInfo() << QStringLiteral("Update avatar of `%1`. (path=%2)").arg(getUsername()).arg(dest);
+      qInfo() << QStringLiteral("Update avatar of `%1`. (path=%2, id=%3)").arg(getUsername()).arg(path).arg(fileId);
     }
   }
 
@@ -190,7 +179,8 @@ bool VcardModel::setAvatar (const QString &path) {
     photo->setValue(VCARD_SCHEME + ::Utils::appStringToCoreString(fileId));
 
     if (!belcard->addPhoto(photo)) {
-      file.remove();
+      if (isNewFile)
+        AvatarProvider::removeAvatar(fileId);
       return false;
     }
   }
@@ -283,21 +273,25 @@ void VcardModel::setCountry (const QString &country) {
 // -----------------------------------------------------------------------------
 
 QVariantList VcardModel::getSipAddresses () const {
+  if (mSipAddressesAreValid)
+    return mSipAddresses;
+
   shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
-  QVariantList list;
+  mSipAddresses.clear();
 
   for (const auto &address : mVcard->getVcard()->getImpp()) {
     string value = address->getValue();
     shared_ptr<linphone::Address> linphoneAddress = core->createAddress(value);
 
     if (linphoneAddress)
-      list << ::Utils::coreStringToAppString(linphoneAddress->asStringUriOnly());
+      mSipAddresses << ::Utils::coreStringToAppString(linphoneAddress->asStringUriOnly());
     else
       qWarning() << QStringLiteral("Unable to parse sip address: `%1`")
         .arg(::Utils::coreStringToAppString(value));
   }
 
-  return list;
+  mSipAddressesAreValid = true;
+  return mSipAddresses;
 }
 
 bool VcardModel::addSipAddress (const QString &sipAddress) {
@@ -321,6 +315,7 @@ bool VcardModel::addSipAddress (const QString &sipAddress) {
   }
 
   qInfo() << QStringLiteral("Add new sip address on vcard: `%1`.").arg(sipAddress);
+  mSipAddressesAreValid = false;
 
   emit vcardUpdated();
   return true;
@@ -348,6 +343,7 @@ void VcardModel::removeSipAddress (const QString &sipAddress) {
 
   qInfo() << QStringLiteral("Remove sip address on vcard: `%1`.").arg(sipAddress);
   belcard->removeImpp(value);
+  mSipAddressesAreValid = false;
 
   emit vcardUpdated();
 }
@@ -64,6 +64,7 @@ public:
 
   // ---------------------------------------------------------------------------
 
+  // Parsed once, until the sip addresses of the vcard are changed.
   QVariantList getSipAddresses () const;
   QVariantMap getAddress () const;
   QVariantList getEmails () const;
@@ -105,6 +106,9 @@ private:
   bool mAvatarIsReadOnly = true;
 
   std::shared_ptr<linphone::Vcard> mVcard;
+
+  mutable QVariantList mSipAddresses;
+  mutable bool mSipAddressesAreValid = false;
 };
 
 Q_DECLARE_METATYPE(VcardModel *);
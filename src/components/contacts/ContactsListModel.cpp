@@ -20,6 +20,11 @@
  *      Author: Ronan Abhamon
  */
 
+#include <belcard/belcard.hpp>
+#include <belcard/belcard_parser.hpp>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
 #include <QtDebug>
 
 #include "../../app/App.hpp"
@@ -32,6 +37,90 @@ using namespace std;
 
 // =============================================================================
 
+// Parses a vcf file line by line. Vcards with the same username are merged.
+template<class Func>
+list<shared_ptr<belcard::BelCard> > parseVcardsFile (const QString &filePath, Func notifyProgress) {
+  list<shared_ptr<belcard::BelCard> > belcards;
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << QStringLiteral("Unable to open vcards file: `%1`.").arg(filePath);
+    return belcards;
+  }
+
+  // Not shared with the parser of the core, which runs in the main thread.
+  belcard::BelCardParser parser;
+  QHash<QString, shared_ptr<belcard::BelCard> > belcardsByUsername;
+
+  const qint64 size = qMax(file.size(), qint64(1));
+  int progress = 0;
+
+  string vcard;
+  while (!file.atEnd()) {
+    // The parser expects CRLF line endings.
+    const QByteArray line = file.readLine();
+    int length = line.length();
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+      --length;
+    vcard.append(line.constData(), static_cast<size_t>(length)).append("\r\n");
+
+    if (qstricmp(line.left(length).trimmed().constData(), "END:VCARD") != 0)
+      continue;
+
+    shared_ptr<belcard::BelCard> belcard = parser.parseOne(vcard);
+    vcard.clear();
+
+    if (!belcard || !belcard->getFullName()) {
+      qWarning() << QStringLiteral("Unable to parse vcard in: `%1`.").arg(filePath);
+      continue;
+    }
+
+    const QString username = ::Utils::coreStringToAppString(belcard->getFullName()->getValue());
+    shared_ptr<belcard::BelCard> sameBelcard = belcardsByUsername.value(username);
+    if (!sameBelcard) {
+      belcardsByUsername.insert(username, belcard);
+      belcards.push_back(belcard);
+    } else {
+      for (const auto &impp : belcard->getImpp()) {
+        const list<shared_ptr<belcard::BelCardImpp> > &impps = sameBelcard->getImpp();
+        const string value = impp->getValue();
+        if (find_if(impps.cbegin(), impps.cend(), [&value](const shared_ptr<belcard::BelCardImpp> &sameImpp) {
+              return sameImpp->getValue() == value;
+            }) == impps.cend())
+          sameBelcard->addImpp(impp);
+      }
+    }
+
+    int newProgress = static_cast<int>(file.pos() * 100 / size);
+    if (newProgress != progress)
+      notifyProgress((progress = newProgress) / 100.f);
+  }
+
+  return belcards;
+}
+
+// Builds a linphone vcard with the properties used by `VcardModel`.
+inline shared_ptr<linphone::Vcard> createVcard (const shared_ptr<belcard::BelCard> &belcard) {
+  shared_ptr<linphone::Vcard> vcard = linphone::Factory::get()->createVcard();
+  vcard->setFullName(belcard->getFullName()->getValue());
+
+  shared_ptr<belcard::BelCard> newBelcard = vcard->getVcard();
+  for (const auto &impp : belcard->getImpp())
+    newBelcard->addImpp(impp);
+  for (const auto &role : belcard->getRoles())
+    newBelcard->addRole(role);
+  for (const auto &email : belcard->getEmails())
+    newBelcard->addEmail(email);
+  for (const auto &url : belcard->getURLs())
+    newBelcard->addURL(url);
+  for (const auto &address : belcard->getAddresses())
+    newBelcard->addAddress(address);
+
+  return vcard;
+}
+
+// -----------------------------------------------------------------------------
+
 ContactsListModel::ContactsListModel (QObject *parent) : QAbstractListModel(parent) {
   mLinphoneFriends = CoreManager::getInstance()->getCore()->getFriendsLists().front();
 
@@ -49,17 +138,16 @@ ContactsListModel::ContactsListModel (QObject *parent) : QAbstractListModel(pare
     }
   }
 
-  // Init contacts with linphone friends list.
-  QQmlEngine *engine = App::getInstance()->getEngine();
-  for (const auto &linphoneFriend : mLinphoneFriends->getFriends()) {
-    ContactModel *contact = new ContactModel(this, linphoneFriend);
+  // Init contacts with linphone friends list. The models are created on demand.
+  for (const auto &linphoneFriend : mLinphoneFriends->getFriends())
+    mList << createEntry(linphoneFriend);
+}
 
-    // See: http://doc.qt.io/qt-5/qtqml-cppintegration-data.html#data-ownership
-    // The returned value must have a explicit parent or a QQmlEngine::CppOwnership.
-    engine->setObjectOwnership(contact, QQmlEngine::CppOwnership);
+ContactsListModel::~ContactsListModel () {
+  if (mImportWatcher)
+    mImportWatcher->waitForFinished();
 
-    addContact(contact);
-  }
+  qDeleteAll(mList);
 }
 
 int ContactsListModel::rowCount (const QModelIndex &) const {
@@ -79,7 +167,7 @@ QVariant ContactsListModel::data (const QModelIndex &index, int role) const {
     return QVariant();
 
   if (role == Qt::DisplayRole)
-    return QVariant::fromValue(mList[row]);
+    return QVariant::fromValue(getContactModel(mList[row]));
 
   return QVariant();
 }
@@ -97,12 +185,19 @@ bool ContactsListModel::removeRows (int row, int count, const QModelIndex &paren
   beginRemoveRows(parent, row, limit);
 
   for (int i = 0; i < count; ++i) {
-    ContactModel *contact = mList.takeAt(row);
+    ContactEntry *entry = mList.takeAt(row);
+    ContactModel *contact = getContactModel(entry);
 
-    mLinphoneFriends->removeFriend(contact->mLinphoneFriend);
+    mLinphoneFriends->removeFriend(entry->linphoneFriend);
+    mEntriesByFriend.remove(entry->linphoneFriend.get());
+
+    for (const auto &sipAddress : entry->sipAddresses)
+      removeSipAddressOfContact(entry, sipAddress);
 
     emit contactRemoved(contact);
     contact->deleteLater();
+
+    delete entry;
   }
 
   endRemoveRows();
@@ -113,19 +208,25 @@ bool ContactsListModel::removeRows (int row, int count, const QModelIndex &paren
 // -----------------------------------------------------------------------------
 
 ContactModel *ContactsListModel::findContactModelFromSipAddress (const QString &sipAddress) const {
-  auto it = find_if(mList.begin(), mList.end(), [&sipAddress](ContactModel *contactModel) {
-        return contactModel->getVcardModel()->getSipAddresses().contains(sipAddress);
-      });
-
-  return it != mList.end() ? *it : nullptr;
+  ContactEntry *entry = findEntryFromSipAddress(sipAddress);
+  return entry ? getContactModel(entry) : nullptr;
 }
 
 ContactModel *ContactsListModel::findContactModelFromUsername (const QString &username) const {
-  auto it = find_if(mList.begin(), mList.end(), [&username](ContactModel *contactModel) {
-        return contactModel->getVcardModel()->getUsername() == username;
+  auto it = find_if(mList.begin(), mList.end(), [&username](const ContactEntry *entry) {
+        return entry->username == username;
       });
 
-  return it != mList.end() ? *it : nullptr;
+  return it != mList.end() ? getContactModel(*it) : nullptr;
+}
+
+QString ContactsListModel::findUsernameFromSipAddress (const QString &sipAddress) const {
+  const ContactEntry *entry = findEntryFromSipAddress(sipAddress);
+  if (!entry)
+    return QString();
+
+  // A contact without username must not look like a missing contact.
+  return entry->username.isNull() ? QString("") : entry->username;
 }
 
 // -----------------------------------------------------------------------------
@@ -158,7 +259,12 @@ ContactModel *ContactsListModel::addContact (VcardModel *vcardModel) {
   int row = mList.count();
 
   beginInsertRows(QModelIndex(), row, row);
-  addContact(contact);
+
+  ContactEntry *entry = createEntry(contact->mLinphoneFriend);
+  entry->contact = contact;
+  connectToContactModel(entry);
+  mList << entry;
+
   endInsertRows();
 
   emit contactAdded(contact);
@@ -169,17 +275,103 @@ ContactModel *ContactsListModel::addContact (VcardModel *vcardModel) {
 void ContactsListModel::removeContact (ContactModel *contact) {
   qInfo() << QStringLiteral("Removing contact:") << contact;
 
-  int index = mList.indexOf(contact);
-  if (index == -1 || !removeRow(index))
+  auto it = find_if(mList.cbegin(), mList.cend(), [contact](const ContactEntry *entry) {
+        return entry->contact == contact;
+      });
+
+  if (it == mList.cend() || !removeRow(static_cast<int>(distance(mList.cbegin(), it))))
     qWarning() << QStringLiteral("Unable to remove contact:") << contact;
 }
 
 // -----------------------------------------------------------------------------
 
+bool ContactsListModel::importContacts (const QString &filePath) {
+  if (mImportWatcher) {
+    qWarning() << QStringLiteral("Unable to import contacts of `%1`, an import is running.").arg(filePath);
+    return false;
+  }
+
+  if (!QFileInfo(filePath).isReadable()) {
+    qWarning() << QStringLiteral("Unable to import contacts of `%1`, file is not readable.").arg(filePath);
+    return false;
+  }
+
+  qInfo() << QStringLiteral("Import contacts of: `%1`.").arg(filePath);
+
+  mImportWatcher = new QFutureWatcher<list<shared_ptr<belcard::BelCard> > >(this);
+  QObject::connect(mImportWatcher, &QFutureWatcher<list<shared_ptr<belcard::BelCard> > >::finished, this, [this] {
+    handleVcardsParsed(mImportWatcher->result());
+
+    mImportWatcher->deleteLater();
+    mImportWatcher = nullptr;
+  });
+  mImportWatcher->setFuture(QtConcurrent::run([this, filePath] {
+    return ::parseVcardsFile(filePath, [this](float progress) {
+      emit importProgressChanged(progress);
+    });
+  }));
+
+  return true;
+}
+
+void ContactsListModel::handleVcardsParsed (const list<shared_ptr<belcard::BelCard> > &belcards) {
+  // One lookup per vcard instead of one pass on the list.
+  QHash<QString, ContactEntry *> entriesByUsername;
+  entriesByUsername.reserve(mList.count());
+  for (const auto &entry : mList)
+    entriesByUsername.insert(entry->username, entry);
+
+  QList<ContactEntry *> newEntries;
+  QStringList sipAddresses;
+  int count = 0;
+
+  for (const auto &belcard : belcards) {
+    shared_ptr<linphone::Vcard> vcard = ::createVcard(belcard);
+
+    ContactEntry *entry = entriesByUsername.value(::Utils::coreStringToAppString(vcard->getFullName()));
+    if (entry) {
+      getContactModel(entry)->mergeVcardModel(new VcardModel(vcard, false));
+      ++count;
+      continue;
+    }
+
+    shared_ptr<linphone::Friend> linphoneFriend = linphone::Friend::newFromVcard(vcard);
+    if (mLinphoneFriends->addFriend(linphoneFriend) != linphone::FriendListStatus::FriendListStatusOK) {
+      qWarning() << QStringLiteral("Unable to add contact from vcard: `%1`.")
+        .arg(::Utils::coreStringToAppString(vcard->getFullName()));
+      continue;
+    }
+
+    entry = createEntry(linphoneFriend);
+    entriesByUsername.insert(entry->username, entry);
+    newEntries << entry;
+    sipAddresses << entry->sipAddresses;
+    ++count;
+  }
+
+  if (!newEntries.isEmpty()) {
+    beginResetModel();
+    mList << newEntries;
+    endResetModel();
+
+    emit contactsImported(sipAddresses);
+  }
+
+  // One subscription refresh for all the contacts.
+  mLinphoneFriends->updateSubscriptions();
+
+  qInfo() << QStringLiteral("%1 contacts imported.").arg(count);
+  emit importFinished(count);
+}
+
+// -----------------------------------------------------------------------------
+
 void ContactsListModel::cleanAvatars () {
   qInfo() << QStringLiteral("Delete all avatars.");
 
-  for (const auto &contact : mList) {
+  for (const auto &entry : mList) {
+    ContactModel *contact = getContactModel(entry);
+
     VcardModel *vcardModel = contact->cloneVcardModel();
     vcardModel->setAvatar("");
     contact->setVcardModel(vcardModel);
@@ -188,16 +380,99 @@ void ContactsListModel::cleanAvatars () {
 
 // -----------------------------------------------------------------------------
 
-void ContactsListModel::addContact (ContactModel *contact) {
-  QObject::connect(contact, &ContactModel::contactUpdated, this, [this, contact]() {
-      emit contactUpdated(contact);
+void ContactsListModel::refreshPresence (const shared_ptr<linphone::Friend> &linphoneFriend) {
+  ContactEntry *entry = mEntriesByFriend.value(linphoneFriend.get(), nullptr);
+  if (entry && entry->contact)
+    entry->contact->refreshPresence();
+}
+
+// -----------------------------------------------------------------------------
+
+ContactsListModel::ContactEntry *ContactsListModel::createEntry (const shared_ptr<linphone::Friend> &linphoneFriend) {
+  ContactEntry *entry = new ContactEntry();
+  entry->linphoneFriend = linphoneFriend;
+  entry->creationIndex = mEntriesCount++;
+  entry->username = ::Utils::coreStringToAppString(linphoneFriend->getVcard()->getFullName());
+  entry->searchUsername = entry->username.toLower();
+
+  // The friend addresses are parsed from the vcard, like `VcardModel::getSipAddresses`.
+  for (const auto &address : linphoneFriend->getAddresses()) {
+    const QString sipAddress = ::Utils::coreStringToAppString(address->asStringUriOnly());
+    if (entry->sipAddresses.contains(sipAddress))
+      continue;
+
+    entry->sipAddresses << sipAddress;
+    entry->searchSipAddresses << sipAddress.toLower();
+    addSipAddressOfContact(entry, sipAddress);
+  }
+
+  mEntriesByFriend.insert(linphoneFriend.get(), entry);
+
+  return entry;
+}
+
+void ContactsListModel::updateEntry (ContactEntry *entry) {
+  VcardModel *vcardModel = entry->contact->getVcardModel();
+
+  entry->username = vcardModel->getUsername();
+  entry->searchUsername = entry->username.toLower();
+
+  entry->sipAddresses.clear();
+  entry->searchSipAddresses.clear();
+  for (const auto &sipAddress : vcardModel->getSipAddresses()) {
+    entry->sipAddresses << sipAddress.toString();
+    entry->searchSipAddresses << entry->sipAddresses.last().toLower();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+// Like a search in the list, the first contact of the list is returned if several ones use this sip address.
+ContactsListModel::ContactEntry *ContactsListModel::findEntryFromSipAddress (const QString &sipAddress) const {
+  ContactEntry *entry = nullptr;
+  for (auto it = mContactsBySipAddress.constFind(sipAddress); it != mContactsBySipAddress.cend() && it.key() == sipAddress; ++it)
+    if (!entry || (*it)->creationIndex < entry->creationIndex)
+      entry = *it;
+  return entry;
+}
+
+ContactModel *ContactsListModel::getContactModel (ContactEntry *entry) const {
+  if (!entry->contact) {
+    ContactsListModel *model = const_cast<ContactsListModel *>(this);
+    entry->contact = new ContactModel(model, entry->linphoneFriend);
+
+    // See: http://doc.qt.io/qt-5/qtqml-cppintegration-data.html#data-ownership
+    // The returned value must have a explicit parent or a QQmlEngine::CppOwnership.
+    App::getInstance()->getEngine()->setObjectOwnership(entry->contact, QQmlEngine::CppOwnership);
+
+    model->connectToContactModel(entry);
+  }
+
+  return entry->contact;
+}
+
+void ContactsListModel::connectToContactModel (ContactEntry *entry) {
+  ContactModel *contact = entry->contact;
+
+  QObject::connect(contact, &ContactModel::contactUpdated, this, [this, entry]() {
+      updateEntry(entry);
+      emit contactUpdated(entry->contact);
     });
-  QObject::connect(contact, &ContactModel::sipAddressAdded, this, [this, contact](const QString &sipAddress) {
-      emit sipAddressAdded(contact, sipAddress);
+  QObject::connect(contact, &ContactModel::sipAddressAdded, this, [this, entry](const QString &sipAddress) {
+      addSipAddressOfContact(entry, sipAddress);
+      emit sipAddressAdded(entry->contact, sipAddress);
     });
-  QObject::connect(contact, &ContactModel::sipAddressRemoved, this, [this, contact](const QString &sipAddress) {
-      emit sipAddressRemoved(contact, sipAddress);
+  QObject::connect(contact, &ContactModel::sipAddressRemoved, this, [this, entry](const QString &sipAddress) {
+      removeSipAddressOfContact(entry, sipAddress);
+      emit sipAddressRemoved(entry->contact, sipAddress);
     });
+}
+
+void ContactsListModel::addSipAddressOfContact (ContactEntry *entry, const QString &sipAddress) {
+  if (!mContactsBySipAddress.contains(sipAddress, entry))
+    mContactsBySipAddress.insert(sipAddress, entry);
+}
 
-  mList << contact;
+void ContactsListModel::removeSipAddressOfContact (ContactEntry *entry, const QString &sipAddress) {
+  mContactsBySipAddress.remove(sipAddress, entry);
 }
@@ -25,19 +25,25 @@
 
 #include <linphone++/linphone.hh>
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 
 #include "../contact/ContactModel.hpp"
 
 // =============================================================================
 
+namespace belcard {
+  class BelCard;
+}
+
 class ContactsListModel : public QAbstractListModel {
+  friend class ContactsListProxyModel;
   friend class SipAddressesModel;
 
   Q_OBJECT;
 
 public:
   ContactsListModel (QObject *parent = Q_NULLPTR);
-  ~ContactsListModel () = default;
+  ~ContactsListModel ();
 
   int rowCount (const QModelIndex &index = QModelIndex()) const override;
 
@@ -47,14 +53,27 @@ public:
   bool removeRow (int row, const QModelIndex &parent = QModelIndex());
   bool removeRows (int row, int count, const QModelIndex &parent = QModelIndex()) override;
 
+  // No sip address is parsed. O(k), with k contacts using the sip address.
   ContactModel *findContactModelFromSipAddress (const QString &sipAddress) const;
   ContactModel *findContactModelFromUsername (const QString &username) const;
 
+  // Same lookup as `findContactModelFromSipAddress` but the contact model is not created.
+  // Returns a null string if no contact is found.
+  QString findUsernameFromSipAddress (const QString &sipAddress) const;
+
   Q_INVOKABLE ContactModel *addContact (VcardModel *vcardModel);
   Q_INVOKABLE void removeContact (ContactModel *contact);
 
+  // Parses the vcards of a file on a worker thread, then adds them at once.
+  // Vcards are merged by username.
+  // Returns false if the file can't be read or if an import is running.
+  Q_INVOKABLE bool importContacts (const QString &filePath);
+
   Q_INVOKABLE void cleanAvatars ();
 
+  // Does nothing if the model of the contact is not created.
+  void refreshPresence (const std::shared_ptr<linphone::Friend> &linphoneFriend);
+
 signals:
   void contactAdded (ContactModel *contact);
   void contactRemoved (const ContactModel *contact);
@@ -63,11 +82,55 @@ signals:
   void sipAddressAdded (ContactModel *contact, const QString &sipAddress);
   void sipAddressRemoved (ContactModel *contact, const QString &sipAddress);
 
+  // Emitted instead of `contactAdded` for the new contacts of an import.
+  void contactsImported (const QStringList &sipAddresses);
+
+  // Progress of the file parsing, between 0 and 1. Emitted by the worker thread.
+  void importProgressChanged (float progress);
+  // Count of added or merged contacts.
+  void importFinished (int count);
+
 private:
-  void addContact (ContactModel *contact);
+  // Loaded for each friend at startup. The models of a contact are created
+  // when its row is bound, when it is looked up or when it is removed.
+  struct ContactEntry {
+    std::shared_ptr<linphone::Friend> linphoneFriend;
+    ContactModel *contact = nullptr;
+
+    // Entries are only appended to the list: it's also the order in the list.
+    quint64 creationIndex = 0;
+
+    QString username;
+    QStringList sipAddresses;
 
-  QList<ContactModel *> mList;
+    // Lowercase keys matched by `ContactsListProxyModel`.
+    QString searchUsername;
+    QStringList searchSipAddresses;
+  };
+
+  void handleVcardsParsed (const std::list<std::shared_ptr<belcard::BelCard> > &belcards);
+
+  ContactEntry *createEntry (const std::shared_ptr<linphone::Friend> &linphoneFriend);
+  void updateEntry (ContactEntry *entry);
+
+  ContactEntry *findEntryFromSipAddress (const QString &sipAddress) const;
+  ContactModel *getContactModel (ContactEntry *entry) const;
+  void connectToContactModel (ContactEntry *entry);
+
+  void addSipAddressOfContact (ContactEntry *entry, const QString &sipAddress);
+  void removeSipAddressOfContact (ContactEntry *entry, const QString &sipAddress);
+
+  QList<ContactEntry *> mList;
+
+  // Owned by this model: the data of a friend is shared by all the instances of the model.
+  QHash<const linphone::Friend *, ContactEntry *> mEntriesByFriend;
+
+  // Sip address => contacts. Updated before the signals of this model.
+  QMultiHash<QString, ContactEntry *> mContactsBySipAddress;
+  quint64 mEntriesCount = 0; // Created since the model creation.
   std::shared_ptr<linphone::FriendList> mLinphoneFriends;
+
+  QFutureWatcher<std::list<std::shared_ptr<belcard::BelCard> > > *mImportWatcher = nullptr;
 };
 
 #endif // CONTACTS_LIST_MODEL_H_
@@ -23,8 +23,8 @@
 #include <cmath>
 
 #include <QDebug>
+#include <QtConcurrent>
 
-#include "../../utils/Utils.hpp"
 #include "../core/CoreManager.hpp"
 
 #include "ContactsListProxyModel.hpp"
@@ -38,6 +38,9 @@
 #define FACTOR_POS_3 0.7f
 #define FACTOR_POS_OTHER 0.6f
 
+// Contacts scored by one task of `updateWeights`.
+#define WEIGHTS_CHUNK_MIN_SIZE 500
+
 using namespace std;
 
 // =============================================================================
@@ -56,58 +59,122 @@ const QRegExp ContactsListProxyModel::mSearchSeparators("^[^_.-;@ ][_.-;@ ]");
 // -----------------------------------------------------------------------------
 
 ContactsListProxyModel::ContactsListProxyModel (QObject *parent) : QSortFilterProxyModel(parent) {
-  setSourceModel(CoreManager::getInstance()->getContactsListModel());
+  ContactsListModel *model = CoreManager::getInstance()->getContactsListModel();
+
+  // Connected before the proxy: the weights are ready when it filters the changed rows.
+  QObject::connect(model, &ContactsListModel::contactUpdated, this, [this, model](ContactModel *contact) {
+      const linphone::Friend *linphoneFriend = contact->mLinphoneFriend.get();
+      const ContactsListModel::ContactEntry *entry = model->mEntriesByFriend.value(linphoneFriend, nullptr);
+      if (entry)
+        mWeights.insert(linphoneFriend, computeContactWeight(entry, mFilter, mSearchSeparators));
+    });
+  QObject::connect(model, &ContactsListModel::contactRemoved, this, [this](const ContactModel *contact) {
+      mWeights.remove(contact->mLinphoneFriend.get());
+    });
+  QObject::connect(model, &ContactsListModel::rowsInserted, this, &ContactsListProxyModel::handleSourceRowsInserted);
+  QObject::connect(model, &ContactsListModel::modelReset, this, &ContactsListProxyModel::updateWeights);
+
+  setSourceModel(model);
+  updateWeights();
   sort(0);
 }
 
 // -----------------------------------------------------------------------------
 
 void ContactsListProxyModel::setFilter (const QString &pattern) {
-  mFilter = pattern;
+  mFilter = pattern.toLower();
+  updateWeights();
   invalidate();
 }
 
 // -----------------------------------------------------------------------------
 
-bool ContactsListProxyModel::filterAcceptsRow (
-  int sourceRow,
-  const QModelIndex &sourceParent
-) const {
-  const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-  const ContactModel *contact = index.data().value<ContactModel *>();
+// The entries of the source model are read directly, the contact models are
+// only created for the rows bound to a view.
 
-  mWeights[contact] = static_cast<unsigned int>(round(computeContactWeight(contact)));
+bool ContactsListProxyModel::filterAcceptsRow (int sourceRow, const QModelIndex &) const {
+  const ContactsListModel::ContactEntry *entry = static_cast<ContactsListModel *>(sourceModel())->mList[sourceRow];
 
-  return mWeights[contact] > 0 && (
+  return mWeights.value(entry->linphoneFriend.get()) > 0 && (
     !mUseConnectedFilter ||
-    contact->getPresenceLevel() != Presence::PresenceLevel::White
+    Presence::getPresenceLevel(
+      static_cast<Presence::PresenceStatus>(entry->linphoneFriend->getConsolidatedPresence())
+    ) != Presence::PresenceLevel::White
   );
 }
 
 bool ContactsListProxyModel::lessThan (const QModelIndex &left, const QModelIndex &right) const {
-  const ContactModel *contactA = sourceModel()->data(left).value<ContactModel *>();
-  const ContactModel *contactB = sourceModel()->data(right).value<ContactModel *>();
+  const QList<ContactsListModel::ContactEntry *> &entries = static_cast<ContactsListModel *>(sourceModel())->mList;
+  const ContactsListModel::ContactEntry *entryA = entries[left.row()];
+  const ContactsListModel::ContactEntry *entryB = entries[right.row()];
 
-  unsigned int weightA = mWeights[contactA];
-  unsigned int weightB = mWeights[contactB];
+  unsigned int weightA = mWeights.value(entryA->linphoneFriend.get());
+  unsigned int weightB = mWeights.value(entryB->linphoneFriend.get());
 
   // Sort by weight and name.
   return weightA > weightB || (
     weightA == weightB &&
-    contactA->mLinphoneFriend->getName() <= contactB->mLinphoneFriend->getName()
+    entryA->username <= entryB->username
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+void ContactsListProxyModel::updateWeights () {
+  const QList<ContactsListModel::ContactEntry *> entries = static_cast<ContactsListModel *>(sourceModel())->mList;
+  const int count = entries.count();
+
+  // Each task writes its own slice of `weights`, no lock is necessary.
+  QVector<unsigned int> weights(count);
+  unsigned int *results = weights.data();
+
+  const int chunkSize = qMax(
+    WEIGHTS_CHUNK_MIN_SIZE,
+    count / qMax(1, QThreadPool::globalInstance()->maxThreadCount()) + 1
   );
+
+  QVector<int> chunks;
+  for (int i = 0; i < count; i += chunkSize)
+    chunks << i;
+
+  const QString filter = mFilter;
+  QtConcurrent::blockingMap(chunks, [&entries, results, chunkSize, count, &filter](const int &begin) {
+    const QRegExp separators(mSearchSeparators);
+    const int end = qMin(begin + chunkSize, count);
+
+    for (int i = begin; i < end; ++i)
+      results[i] = computeContactWeight(entries[i], filter, separators);
+  });
+
+  QHash<const linphone::Friend *, unsigned int> newWeights;
+  newWeights.reserve(count);
+  for (int i = 0; i < count; ++i)
+    newWeights.insert(entries[i]->linphoneFriend.get(), weights[i]);
+
+  mWeights.swap(newWeights);
+}
+
+void ContactsListProxyModel::handleSourceRowsInserted (const QModelIndex &, int first, int last) {
+  const QList<ContactsListModel::ContactEntry *> &entries = static_cast<ContactsListModel *>(sourceModel())->mList;
+  for (int row = first; row <= last; ++row)
+    mWeights.insert(entries[row]->linphoneFriend.get(), computeContactWeight(entries[row], mFilter, mSearchSeparators));
 }
 
 // -----------------------------------------------------------------------------
 
-float ContactsListProxyModel::computeStringWeight (const QString &string, float percentage) const {
+float ContactsListProxyModel::computeStringWeight (
+  const QString &string,
+  const QString &filter,
+  const QRegExp &separators,
+  float percentage
+) {
   int index = -1;
   int offset = -1;
 
-  // Search pattern.
-  while ((index = string.indexOf(mFilter, index + 1, Qt::CaseInsensitive)) != -1) {
+  // Search pattern. Both strings are lowercase.
+  while ((index = string.indexOf(filter, index + 1)) != -1) {
     // Search n chars between one separator and index.
-    int tmpOffset = index - string.lastIndexOf(mSearchSeparators, index) - 1;
+    int tmpOffset = index - string.lastIndexOf(separators, index) - 1;
 
     if ((tmpOffset != -1 && tmpOffset < offset) || offset == -1)
       if ((offset = tmpOffset) == 0) break;
@@ -125,20 +192,19 @@ float ContactsListProxyModel::computeStringWeight (const QString &string, float
   return percentage * FACTOR_POS_OTHER;
 }
 
-float ContactsListProxyModel::computeContactWeight (const ContactModel *contact) const {
-  float weight = computeStringWeight(contact->getVcardModel()->getUsername(), USERNAME_WEIGHT);
-
-  // Get all contact's addresses.
-  const list<shared_ptr<linphone::Address> > addresses = contact->mLinphoneFriend->getAddresses();
+unsigned int ContactsListProxyModel::computeContactWeight (
+  const ContactsListModel::ContactEntry *entry,
+  const QString &filter,
+  const QRegExp &separators
+) {
+  float weight = computeStringWeight(entry->searchUsername, filter, separators, USERNAME_WEIGHT);
 
-  float size = static_cast<float>(addresses.size());
-  for (auto it = addresses.cbegin(); it != addresses.cend(); ++it)
-    weight += computeStringWeight(
-        ::Utils::coreStringToAppString((*it)->asStringUriOnly()),
-        SIP_ADDRESSES_WEIGHT / size
-      );
+  const QStringList &sipAddresses = entry->searchSipAddresses;
+  float size = static_cast<float>(sipAddresses.size());
+  for (const auto &sipAddress : sipAddresses)
+    weight += computeStringWeight(sipAddress, filter, separators, SIP_ADDRESSES_WEIGHT / size);
 
-  return weight;
+  return static_cast<unsigned int>(round(weight));
 }
 
 // -----------------------------------------------------------------------------
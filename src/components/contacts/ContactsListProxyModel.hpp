@@ -25,10 +25,9 @@
 
 #include <QSortFilterProxyModel>
 
-// =============================================================================
+#include "ContactsListModel.hpp"
 
-class ContactModel;
-class ContactsListModel;
+// =============================================================================
 
 class ContactsListProxyModel : public QSortFilterProxyModel {
   Q_OBJECT;
@@ -50,8 +49,24 @@ protected:
   bool lessThan (const QModelIndex &left, const QModelIndex &right) const override;
 
 private:
-  float computeStringWeight (const QString &string, float percentage) const;
-  float computeContactWeight (const ContactModel *contact) const;
+  // Scores all contacts on the thread pool and commits the new weights at once.
+  void updateWeights ();
+
+  // Weights of the contacts added one by one. (Imports reset the model.)
+  void handleSourceRowsInserted (const QModelIndex &parent, int first, int last);
+
+  // Thread-safe if each thread uses its own copy of `separators`.
+  static float computeStringWeight (
+    const QString &string,
+    const QString &filter,
+    const QRegExp &separators,
+    float percentage
+  );
+  static unsigned int computeContactWeight (
+    const ContactsListModel::ContactEntry *entry,
+    const QString &filter,
+    const QRegExp &separators
+  );
 
   bool isConnectedFilterUsed () const {
     return mUseConnectedFilter;
@@ -59,12 +74,13 @@ private:
 
   void setConnectedFilter (bool useConnectedFilter);
 
+  // Lowercase, like the search keys of the contacts.
   QString mFilter;
   bool mUseConnectedFilter = false;
 
-  // It's just a cache to save values computed by `filterAcceptsRow`
-  // and reused by `lessThan`.
-  mutable QHash<const ContactModel *, unsigned int> mWeights;
+  // Computed by `updateWeights` and reused by `filterAcceptsRow` and `lessThan`.
+  // The weights of new or updated contacts are computed when the source model signals them.
+  QHash<const linphone::Friend *, unsigned int> mWeights;
 
   static const QRegExp mSearchSeparators;
 };
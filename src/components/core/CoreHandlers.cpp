@@ -151,9 +151,9 @@ void CoreHandlers::onNotifyPresenceReceived (
   const shared_ptr<linphone::Core> &,
   const shared_ptr<linphone::Friend> &linphoneFriend
 ) {
-  // Ignore friend without vcard because the `contact-model` data doesn't exist.
+  // Ignore friend without vcard because it's not in the contacts list.
   if (linphoneFriend->getVcard())
-    linphoneFriend->getData<ContactModel>("contact-model").refreshPresence();
+    CoreManager::getInstance()->getContactsListModel()->refreshPresence(linphoneFriend);
 }
 
 void CoreHandlers::onRegistrationStateChanged (
@@ -53,9 +53,12 @@ CoreManager::CoreManager (QObject *parent, const QString &configPath) : QObject(
   QObject::connect(mHandlers.get(), &CoreHandlers::coreStarted, this, [] {
     mInstance->mCallsListModel = new CallsListModel(mInstance);
     mInstance->mContactsListModel = new ContactsListModel(mInstance);
+    mInstance->mMessageSearchService = new MessageSearchService(mInstance);
     mInstance->mSipAddressesModel = new SipAddressesModel(mInstance);
     mInstance->mSettingsModel = new SettingsModel(mInstance);
     mInstance->mAccountSettingsModel = new AccountSettingsModel(mInstance);
+    mInstance->mDownloadManager = new DownloadManager(mInstance);
+    mInstance->mChatModelsCache = new ChatModelsCache(mInstance);
 
     emit mInstance->coreStarted();
   });
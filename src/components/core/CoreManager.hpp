@@ -28,7 +28,10 @@
 #include <QMutex>
 
 #include "../calls/CallsListModel.hpp"
+#include "../chat/ChatModelsCache.hpp"
 #include "../contacts/ContactsListModel.hpp"
+#include "../downloads/DownloadManager.hpp"
+#include "../message-search/MessageSearchService.hpp"
 #include "../settings/AccountSettingsModel.hpp"
 #include "../settings/SettingsModel.hpp"
 #include "../sip-addresses/SipAddressesModel.hpp"
@@ -79,11 +82,26 @@ public:
     return mCallsListModel;
   }
 
+  ChatModelsCache *getChatModelsCache () const {
+    Q_ASSERT(mChatModelsCache != nullptr);
+    return mChatModelsCache;
+  }
+
   ContactsListModel *getContactsListModel () const {
     Q_ASSERT(mContactsListModel != nullptr);
     return mContactsListModel;
   }
 
+  DownloadManager *getDownloadManager () const {
+    Q_ASSERT(mDownloadManager != nullptr);
+    return mDownloadManager;
+  }
+
+  MessageSearchService *getMessageSearchService () const {
+    Q_ASSERT(mMessageSearchService != nullptr);
+    return mMessageSearchService;
+  }
+
   SipAddressesModel *getSipAddressesModel () const {
     Q_ASSERT(mSipAddressesModel != nullptr);
     return mSipAddressesModel;
@@ -142,7 +160,10 @@ private:
   std::shared_ptr<CoreHandlers> mHandlers;
 
   CallsListModel *mCallsListModel;
+  ChatModelsCache *mChatModelsCache;
   ContactsListModel *mContactsListModel;
+  DownloadManager *mDownloadManager;
+  MessageSearchService *mMessageSearchService;
   SipAddressesModel *mSipAddressesModel;
   SettingsModel *mSettingsModel;
   AccountSettingsModel *mAccountSettingsModel;
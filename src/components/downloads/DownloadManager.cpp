@@ -0,0 +1,337 @@
+/*
+ * DownloadManager.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <QFile>
+#include <QTimer>
+
+#include "../../utils/Utils.hpp"
+#include "../core/CoreManager.hpp"
+
+#include "DownloadManager.hpp"
+
+// Attempts of a download interrupted by an error.
+#define MAX_DOWNLOAD_ATTEMPTS 3
+
+// In milliseconds. Doubled at each new attempt.
+#define RETRY_DELAY 2000
+
+// In milliseconds.
+#define PROGRESS_UPDATE_INTERVAL 100
+
+using namespace std;
+
+// =============================================================================
+
+// Removes the file reserved by the first attempt of a download, empty or partial.
+inline void removeReservedFile (const shared_ptr<linphone::ChatMessage> &message) {
+  const QString filePath = ::Utils::coreStringToAppString(message->getFileTransferFilepath());
+  if (!filePath.isEmpty() && !QFile::remove(filePath))
+    qWarning() << QStringLiteral("Unable to remove reserved file: `%1`.").arg(filePath);
+}
+
+// -----------------------------------------------------------------------------
+
+DownloadManager::DownloadManager (QObject *parent) : QObject(parent) {
+  mTimer.start();
+
+  mRetryTimer = new QTimer(this);
+  mRetryTimer->setSingleShot(true);
+  QObject::connect(mRetryTimer, &QTimer::timeout, this, &DownloadManager::startDownloads);
+
+  mProgressTimer = new QTimer(this);
+  mProgressTimer->setSingleShot(true);
+  mProgressTimer->setInterval(PROGRESS_UPDATE_INTERVAL);
+  QObject::connect(mProgressTimer, &QTimer::timeout, this, [this] {
+    emit progressChanged(getProgress());
+  });
+
+  QObject::connect(
+    CoreManager::getInstance()->getSettingsModel(), &SettingsModel::maxConcurrentDownloadsChanged,
+    this, &DownloadManager::startDownloads
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+void DownloadManager::download (const shared_ptr<linphone::ChatMessage> &message, const QString &sipAddress) {
+  shared_ptr<const linphone::Content> content = message->getFileTransferInformation();
+  if (!content || mStartedDownloads.contains(message.get()))
+    return;
+
+  for (const auto &download : mPendingDownloads)
+    if (download.message == message)
+      return;
+
+  Download download;
+  download.message = message;
+  download.sipAddress = sipAddress;
+  download.size = static_cast<qint64>(content->getSize());
+  download.offset = 0;
+  download.attempts = 0;
+  download.startTime = 0;
+
+  mPendingDownloads << download;
+  mTotalBytes += download.size;
+
+  signalCountChanged();
+  signalProgressChanged();
+
+  startDownloads();
+}
+
+void DownloadManager::cancel (const shared_ptr<linphone::ChatMessage> &message) {
+  for (int i = 0; i < mPendingDownloads.count(); ++i)
+    if (mPendingDownloads[i].message == message) {
+      const Download download = mPendingDownloads.takeAt(i);
+      if (download.attempts > 0)
+        ::removeReservedFile(message);
+
+      mTotalBytes -= download.size;
+      if (mPendingDownloads.isEmpty() && mStartedDownloads.isEmpty())
+        mFinishedBytes = mTotalBytes = 0;
+
+      signalCountChanged();
+      signalProgressChanged();
+      return;
+    }
+}
+
+void DownloadManager::cancel (const QString &sipAddress) {
+  const int count = mPendingDownloads.count();
+  for (int i = count - 1; i >= 0; --i)
+    if (mPendingDownloads[i].sipAddress == sipAddress) {
+      const Download download = mPendingDownloads.takeAt(i);
+      if (download.attempts > 0)
+        ::removeReservedFile(download.message);
+
+      mTotalBytes -= download.size;
+    }
+
+  // Finished by `handleMessageStateChanged`, the hash can't be changed during the iteration.
+  QList<shared_ptr<linphone::ChatMessage> > startedMessages;
+  for (const auto &download : mStartedDownloads)
+    if (download.sipAddress == sipAddress)
+      startedMessages << download.message;
+
+  for (const auto &message : startedMessages)
+    message->cancelFileTransfer();
+
+  if (count != mPendingDownloads.count()) {
+    if (mPendingDownloads.isEmpty() && mStartedDownloads.isEmpty())
+      mFinishedBytes = mTotalBytes = 0;
+
+    signalCountChanged();
+    signalProgressChanged();
+  }
+}
+
+void DownloadManager::setPrioritySipAddress (const QString &sipAddress) {
+  mPrioritySipAddress = sipAddress;
+}
+
+// -----------------------------------------------------------------------------
+
+void DownloadManager::handleFileTransferProgress (const shared_ptr<linphone::ChatMessage> &message, size_t offset) {
+  auto it = mStartedDownloads.find(message.get());
+  if (it == mStartedDownloads.end())
+    return;
+
+  it->offset = static_cast<qint64>(offset);
+  signalProgressChanged();
+}
+
+void DownloadManager::handleMessageStateChanged (
+  const shared_ptr<linphone::ChatMessage> &message,
+  linphone::ChatMessageState state
+) {
+  auto it = mStartedDownloads.find(message.get());
+  if (it == mStartedDownloads.end())
+    return;
+
+  switch (state) {
+    case linphone::ChatMessageStateFileTransferDone:
+      finishDownload(mStartedDownloads.take(message.get()), false);
+      break;
+
+    // Restarted later in the same file.
+    case linphone::ChatMessageStateFileTransferError: {
+      Download download = *it;
+      mStartedDownloads.erase(it);
+
+      if (download.attempts < MAX_DOWNLOAD_ATTEMPTS) {
+        qInfo() << QStringLiteral("File download interrupted, retry: `%1`.")
+          .arg(::Utils::coreStringToAppString(message->getFileTransferFilepath()));
+
+        download.offset = 0;
+        download.startTime = mTimer.elapsed() + (RETRY_DELAY << (download.attempts - 1));
+        mPendingDownloads << download;
+
+        signalProgressChanged();
+        startDownloads();
+      } else {
+        qWarning() << QStringLiteral("Unable to download file: `%1`.")
+          .arg(::Utils::coreStringToAppString(message->getFileTransferFilepath()));
+
+        finishDownload(download, true);
+      }
+    } break;
+
+    // Cancelled.
+    case linphone::ChatMessageStateNotDelivered:
+      finishDownload(mStartedDownloads.take(message.get()), true);
+      break;
+
+    default:
+      break;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+int DownloadManager::getCount () const {
+  return mPendingDownloads.count() + mStartedDownloads.count();
+}
+
+float DownloadManager::getProgress () const {
+  if (mTotalBytes <= 0)
+    return 0;
+
+  qint64 receivedBytes = mFinishedBytes;
+  for (const auto &download : mStartedDownloads)
+    receivedBytes += download.offset;
+
+  return qMin(1.0f, static_cast<float>(receivedBytes) / mTotalBytes);
+}
+
+// -----------------------------------------------------------------------------
+
+void DownloadManager::startDownloads () {
+  const int maxCount = qMax(1, CoreManager::getInstance()->getSettingsModel()->getMaxConcurrentDownloads());
+
+  while (mStartedDownloads.count() < maxCount) {
+    const qint64 now = mTimer.elapsed();
+
+    // First ready download, the ones of the visible chat before the others.
+    int index = -1;
+    for (int i = 0; i < mPendingDownloads.count(); ++i) {
+      const Download &download = mPendingDownloads[i];
+      if (download.startTime > now)
+        continue;
+
+      if (download.sipAddress == mPrioritySipAddress) {
+        index = i;
+        break;
+      }
+
+      if (index < 0)
+        index = i;
+    }
+
+    if (index < 0)
+      break;
+
+    // Added before the start: the state can be changed synchronously.
+    Download download = mPendingDownloads.takeAt(index);
+    const void *key = download.message.get();
+    mStartedDownloads.insert(key, download);
+
+    if (!startDownload(mStartedDownloads[key]) && mStartedDownloads.contains(key))
+      finishDownload(mStartedDownloads.take(key), true);
+  }
+
+  // Wait for the next download to retry.
+  if (mStartedDownloads.count() < maxCount && !mPendingDownloads.isEmpty()) {
+    qint64 startTime = mPendingDownloads.first().startTime;
+    for (const auto &download : mPendingDownloads)
+      startTime = qMin(startTime, download.startTime);
+
+    mRetryTimer->start(static_cast<int>(qMax(static_cast<qint64>(0), startTime - mTimer.elapsed())));
+  }
+}
+
+bool DownloadManager::startDownload (Download &download) {
+  shared_ptr<linphone::ChatMessage> message = download.message;
+
+  // A new attempt overwrites the file of the previous one.
+  if (download.attempts == 0) {
+    bool soFarSoGood;
+    const QString safeFilePath = ::Utils::getSafeFilePath(
+        QStringLiteral("%1%2")
+        .arg(CoreManager::getInstance()->getSettingsModel()->getDownloadFolder())
+        .arg(::Utils::coreStringToAppString(message->getFileTransferInformation()->getName())),
+        &soFarSoGood
+      );
+
+    if (!soFarSoGood) {
+      qWarning() << QStringLiteral("Unable to create safe file path for: `%1`.").arg(safeFilePath);
+      return false;
+    }
+
+    // Reserve the path: another download of the same file name can be started now.
+    QFile file(safeFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+      qWarning() << QStringLiteral("Unable to create file: `%1`.").arg(safeFilePath);
+      return false;
+    }
+
+    message->setFileTransferFilepath(::Utils::appStringToCoreString(safeFilePath));
+  }
+
+  ++download.attempts;
+
+  if (message->downloadFile() < 0) {
+    qWarning() << QStringLiteral("Unable to download file: `%1`.")
+      .arg(::Utils::coreStringToAppString(message->getFileTransferFilepath()));
+    return false;
+  }
+
+  return true;
+}
+
+void DownloadManager::finishDownload (const Download &download, bool cancelled) {
+  if (cancelled) {
+    if (download.attempts > 0)
+      ::removeReservedFile(download.message);
+
+    mTotalBytes -= download.size;
+  } else
+    mFinishedBytes += download.size;
+
+  if (mPendingDownloads.isEmpty() && mStartedDownloads.isEmpty())
+    mFinishedBytes = mTotalBytes = 0;
+
+  signalCountChanged();
+  signalProgressChanged();
+
+  startDownloads();
+}
+
+// -----------------------------------------------------------------------------
+
+void DownloadManager::signalCountChanged () {
+  emit countChanged(getCount());
+}
+
+void DownloadManager::signalProgressChanged () {
+  if (!mProgressTimer->isActive())
+    mProgressTimer->start();
+}
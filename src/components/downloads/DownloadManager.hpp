@@ -0,0 +1,108 @@
+/*
+ * DownloadManager.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef DOWNLOAD_MANAGER_H_
+#define DOWNLOAD_MANAGER_H_
+
+#include <linphone++/linphone.hh>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+
+// =============================================================================
+// Schedules the downloads of file messages of all chat rooms.
+// At most `maxConcurrentDownloads` transfers are started at the same time,
+// the ones of the priority sip address (the visible chat) first.
+// =============================================================================
+
+class QTimer;
+
+class DownloadManager : public QObject {
+  Q_OBJECT;
+
+  // Number of pending and started downloads.
+  Q_PROPERTY(int count READ getCount NOTIFY countChanged);
+
+  // Progress of the downloads requested since the queue was empty. In [0, 1].
+  Q_PROPERTY(float progress READ getProgress NOTIFY progressChanged);
+
+public:
+  DownloadManager (QObject *parent = Q_NULLPTR);
+  ~DownloadManager () = default;
+
+  // The listener of `message` must be set. Its file is written in the download folder.
+  void download (const std::shared_ptr<linphone::ChatMessage> &message, const QString &sipAddress);
+
+  // Removes a pending download. A started one is stopped by `ChatMessage::cancelFileTransfer`.
+  void cancel (const std::shared_ptr<linphone::ChatMessage> &message);
+
+  // Removes the pending downloads of a chat and stops its started ones.
+  void cancel (const QString &sipAddress);
+
+  void setPrioritySipAddress (const QString &sipAddress);
+
+  // Must be called by the listener of the messages.
+  void handleFileTransferProgress (const std::shared_ptr<linphone::ChatMessage> &message, size_t offset);
+  void handleMessageStateChanged (const std::shared_ptr<linphone::ChatMessage> &message, linphone::ChatMessageState state);
+
+signals:
+  void countChanged (int count);
+  void progressChanged (float progress);
+
+private:
+  struct Download {
+    std::shared_ptr<linphone::ChatMessage> message;
+    QString sipAddress;
+    qint64 size;
+    qint64 offset;
+    int attempts;
+    qint64 startTime; // Not started before this time, after an error.
+  };
+
+  int getCount () const;
+  float getProgress () const;
+
+  void startDownloads ();
+  bool startDownload (Download &download);
+
+  // `download` must be removed of the started downloads.
+  // The file of a cancelled or failed download is removed.
+  void finishDownload (const Download &download, bool cancelled);
+
+  void signalCountChanged ();
+  void signalProgressChanged ();
+
+  QList<Download> mPendingDownloads;
+  QHash<const void *, Download> mStartedDownloads;
+
+  QString mPrioritySipAddress;
+
+  // Sizes of all downloads since the queue was empty.
+  qint64 mFinishedBytes = 0;
+  qint64 mTotalBytes = 0;
+
+  QElapsedTimer mTimer;
+  QTimer *mRetryTimer;
+  QTimer *mProgressTimer;
+};
+
+#endif // DOWNLOAD_MANAGER_H_
@@ -0,0 +1,573 @@
+/*
+ * MessageSearchIndex.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <QDataStream>
+#include <QSaveFile>
+#include <QSet>
+#include <QtDebug>
+
+#include "MessageSearchIndex.hpp"
+
+// Bump the version on each format change.
+#define INDEX_MAGIC 0x4c4d5349 // `LMSI`.
+#define JOURNAL_MAGIC 0x4c4d534a // `LMSJ`.
+#define INDEX_VERSION 1
+
+#define INDEX_STREAM_VERSION QDataStream::Qt_5_0
+
+#define JOURNAL_FILE_SUFFIX ".journal"
+
+// A new snapshot is written beyond this number of journal records.
+#define JOURNAL_MAX_RECORDS_COUNT 50000
+
+// Number of characters displayed before the first match in a snippet.
+#define SNIPPET_CONTEXT_LENGTH 30
+#define SNIPPET_MAX_LENGTH 120
+
+// Size of a serialized document: sip address id, timestamp and storage id.
+#define DOCUMENT_SIZE 16
+
+#define REMOVED_DOCUMENT_ID 0xffffffff
+
+using namespace std;
+
+// =============================================================================
+
+namespace {
+  enum JournalOperation {
+    JournalOperationAdd,
+    JournalOperationRemoveSipAddress,
+    JournalOperationRemoveMessage
+  };
+}
+
+// A count read from disk can't be greater than the number of remaining items.
+inline bool isValidCount (const QFile &file, quint32 count, int itemMinSize) {
+  return count <= static_cast<quint64>(file.size() - file.pos()) / static_cast<quint64>(itemMinSize);
+}
+
+// Lower case words, without diacritics.
+inline QStringList tokenize (const QString &text) {
+  QStringList tokens;
+  QString token;
+
+  for (const QChar &character : text.normalized(QString::NormalizationForm_KD)) {
+    if (character.isLetterOrNumber())
+      token += character.toLower();
+    else if (!character.isMark() && !token.isEmpty()) {
+      tokens << token;
+      token.clear();
+    }
+  }
+
+  if (!token.isEmpty())
+    tokens << token;
+
+  return tokens;
+}
+
+inline QVector<quint32> intersect (const QVector<quint32> &a, const QVector<quint32> &b) {
+  QVector<quint32> result;
+  result.reserve(qMin(a.count(), b.count()));
+  set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(), back_inserter(result));
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+
+MessageSearchIndex::MessageSearchIndex (const QString &filePath) {
+  mFilePath = filePath;
+  mJournal.setFileName(filePath + JOURNAL_FILE_SUFFIX);
+}
+
+// -----------------------------------------------------------------------------
+
+bool MessageSearchIndex::load () {
+  clear();
+
+  QFile file(mFilePath);
+  if (!file.open(QIODevice::ReadOnly) || file.size() == 0) {
+    qInfo() << QStringLiteral("No message search index found: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream.setVersion(INDEX_STREAM_VERSION);
+
+  quint32 magic, version;
+  stream >> magic >> version;
+
+  if (stream.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION) {
+    qWarning() << QStringLiteral("Ignore invalid message search index: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  // Counts are checked before any allocation: a corrupted file must not exhaust the memory.
+  quint32 sipAddressesCount;
+  stream >> mGeneration >> sipAddressesCount;
+  bool valid = stream.status() == QDataStream::Ok && ::isValidCount(file, sipAddressesCount, sizeof(quint32));
+
+  for (quint32 i = 0; valid && i < sipAddressesCount; ++i) {
+    QString sipAddress;
+    stream >> sipAddress;
+    mSipAddresses << sipAddress;
+  }
+
+  quint32 documentsCount = 0;
+  if (valid) {
+    stream >> documentsCount;
+    valid = stream.status() == QDataStream::Ok && ::isValidCount(file, documentsCount, DOCUMENT_SIZE);
+  }
+
+  if (valid) {
+    mDocuments.resize(static_cast<int>(documentsCount));
+    for (Document &document : mDocuments) {
+      stream >> document.sipAddressId >> document.timestamp >> document.storageId;
+      if (document.sipAddressId < 0)
+        ++mRemovedDocumentsCount;
+      else if (document.sipAddressId >= mSipAddresses.count()) {
+        valid = false;
+        break;
+      }
+    }
+  }
+
+  quint32 tokensCount = 0;
+  if (valid) {
+    stream >> tokensCount;
+    valid = stream.status() == QDataStream::Ok && ::isValidCount(file, tokensCount, 2 * sizeof(quint32));
+  }
+
+  for (quint32 i = 0; valid && i < tokensCount && stream.status() == QDataStream::Ok; ++i) {
+    QString token;
+    quint32 idsCount;
+    stream >> token >> idsCount;
+    if (stream.status() != QDataStream::Ok || !::isValidCount(file, idsCount, sizeof(quint32))) {
+      valid = false;
+      break;
+    }
+
+    QVector<quint32> &ids = mPostings[token];
+    ids.resize(static_cast<int>(idsCount));
+    for (quint32 &id : ids)
+      stream >> id;
+
+    // Ids are sorted: the last one is the greatest.
+    valid = ids.isEmpty() || ids.last() < documentsCount;
+  }
+
+  if (!valid || stream.status() != QDataStream::Ok) {
+    qWarning() << QStringLiteral("Ignore corrupted message search index: `%1`.").arg(mFilePath);
+    clear();
+    return false;
+  }
+
+  for (int i = 0; i < mSipAddresses.count(); ++i)
+    mSipAddressIds[mSipAddresses[i]] = i;
+
+  // Additions and removals since the snapshot.
+  if (!replayJournal() && !openJournal(true))
+    qWarning() << QStringLiteral("Unable to reset message search journal: `%1`.").arg(mJournal.fileName());
+
+  qInfo() << QStringLiteral("Message search index loaded: %1 messages, %2 tokens.")
+    .arg(getMessagesCount()).arg(mPostings.count());
+
+  return true;
+}
+
+bool MessageSearchIndex::save () {
+  // Drop the removed messages. The ids keep their order: the postings stay sorted.
+  if (mRemovedDocumentsCount > 0) {
+    QVector<quint32> newIds(mDocuments.count());
+    int count = 0;
+    for (int i = 0; i < mDocuments.count(); ++i) {
+      if (mDocuments[i].sipAddressId < 0) {
+        newIds[i] = REMOVED_DOCUMENT_ID;
+        continue;
+      }
+
+      newIds[i] = static_cast<quint32>(count);
+      mDocuments[count++] = mDocuments[i];
+    }
+
+    mDocuments.resize(count);
+    mDocuments.squeeze();
+    mRemovedDocumentsCount = 0;
+
+    for (auto it = mPostings.begin(); it != mPostings.end(); ) {
+      QVector<quint32> &ids = *it;
+
+      int idsCount = 0;
+      for (quint32 id : ids)
+        if (newIds[static_cast<int>(id)] != REMOVED_DOCUMENT_ID)
+          ids[idsCount++] = newIds[static_cast<int>(id)];
+
+      if (idsCount == 0)
+        it = mPostings.erase(it);
+      else {
+        ids.resize(idsCount);
+        ++it;
+      }
+    }
+  }
+
+  // Write in a temporary file, the old index is replaced only on success.
+  QSaveFile file(mFilePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << QStringLiteral("Unable to open message search index: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream.setVersion(INDEX_STREAM_VERSION);
+
+  // The journal of the previous generation is ignored by the next `load` call.
+  quint32 generation = mGeneration + 1;
+
+  stream << quint32(INDEX_MAGIC) << quint32(INDEX_VERSION) << generation << mSipAddresses;
+  stream << static_cast<quint32>(mDocuments.count());
+
+  for (const Document &document : mDocuments)
+    stream << document.sipAddressId << document.timestamp << document.storageId;
+
+  stream << static_cast<quint32>(mPostings.count());
+  for (auto it = mPostings.cbegin(); it != mPostings.cend(); ++it)
+    stream << it.key() << it.value();
+
+  if (stream.status() != QDataStream::Ok || !file.commit()) {
+    qWarning() << QStringLiteral("Unable to save message search index: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  mGeneration = generation;
+  if (!openJournal(true))
+    qWarning() << QStringLiteral("Unable to reset message search journal: `%1`.").arg(mJournal.fileName());
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void MessageSearchIndex::add (const QList<Message> &messages, bool journaled) {
+  QDataStream stream;
+  if (journaled && mJournal.isOpen()) {
+    stream.setDevice(&mJournal);
+    stream.setVersion(INDEX_STREAM_VERSION);
+  }
+
+  for (const Message &message : messages) {
+    addDocument(message);
+
+    if (stream.device()) {
+      stream << quint8(JournalOperationAdd) << message.sipAddress << message.timestamp << message.storageId << message.text;
+      ++mJournalRecordsCount;
+    }
+  }
+
+  if (stream.device())
+    mJournal.flush();
+}
+
+void MessageSearchIndex::removeSipAddress (const QString &sipAddress, bool journaled) {
+  int id = mSipAddressIds.value(sipAddress, -1);
+  if (id < 0)
+    return;
+
+  for (Document &document : mDocuments)
+    if (document.sipAddressId == id)
+      removeDocument(document);
+
+  if (journaled && mJournal.isOpen()) {
+    QDataStream stream(&mJournal);
+    stream.setVersion(INDEX_STREAM_VERSION);
+    stream << quint8(JournalOperationRemoveSipAddress) << sipAddress;
+    ++mJournalRecordsCount;
+
+    mJournal.flush();
+  }
+}
+
+void MessageSearchIndex::removeMessage (const QString &sipAddress, quint32 storageId, bool journaled) {
+  int id = mSipAddressIds.value(sipAddress, -1);
+  if (id < 0)
+    return;
+
+  // Removals are rare: a linear search, no hash of the storage ids in memory.
+  // The most recent messages are the most likely to be removed.
+  bool removed = false;
+  for (auto it = mDocuments.rbegin(); it != mDocuments.rend(); ++it)
+    if (it->sipAddressId == id && it->storageId == storageId) {
+      removeDocument(*it);
+      removed = true;
+      break;
+    }
+
+  if (removed && journaled && mJournal.isOpen()) {
+    QDataStream stream(&mJournal);
+    stream.setVersion(INDEX_STREAM_VERSION);
+    stream << quint8(JournalOperationRemoveMessage) << sipAddress << storageId;
+    ++mJournalRecordsCount;
+
+    mJournal.flush();
+  }
+}
+
+void MessageSearchIndex::clear () {
+  mSipAddresses.clear();
+  mSipAddressIds.clear();
+
+  mDocuments.clear();
+  mRemovedDocumentsCount = 0;
+
+  mPostings.clear();
+
+  mGeneration = 0;
+  mJournal.close();
+  mJournalRecordsCount = 0;
+}
+
+bool MessageSearchIndex::needsCompaction () const {
+  return mJournalRecordsCount >= JOURNAL_MAX_RECORDS_COUNT || mRemovedDocumentsCount > mDocuments.count() / 2;
+}
+
+// -----------------------------------------------------------------------------
+
+QList<MessageSearchIndex::Result> MessageSearchIndex::search (const QString &pattern, int limit) const {
+  QStringList tokens = ::tokenize(pattern);
+  tokens.removeDuplicates();
+  if (tokens.isEmpty())
+    return QList<Result>();
+
+  const QString prefix = tokens.takeLast();
+
+  // 1. Intersect the messages of the complete tokens, from the rarest.
+  QList<const QVector<quint32> *> postings;
+  for (const QString &token : tokens) {
+    auto it = mPostings.constFind(token);
+    if (it == mPostings.cend())
+      return QList<Result>();
+    postings << &(*it);
+  }
+
+  sort(postings.begin(), postings.end(), [](const QVector<quint32> *a, const QVector<quint32> *b) {
+    return a->count() < b->count();
+  });
+
+  bool hasCandidates = !postings.isEmpty();
+  QVector<quint32> candidates;
+  if (hasCandidates) {
+    candidates = *postings.first();
+    for (int i = 1; i < postings.count() && !candidates.isEmpty(); ++i)
+      candidates = ::intersect(candidates, *postings[i]);
+  }
+
+  // 2. Filter with the last token, it can be incomplete.
+  QList<const QVector<quint32> *> prefixPostings;
+  int prefixPostingsCount = 0;
+  for (auto it = mPostings.lowerBound(prefix); it != mPostings.cend() && it.key().startsWith(prefix); ++it) {
+    prefixPostings << &(*it);
+    prefixPostingsCount += it->count();
+  }
+
+  if (prefixPostings.isEmpty())
+    return QList<Result>();
+
+  if (hasCandidates && static_cast<qint64>(candidates.count()) * prefixPostings.count() < prefixPostingsCount) {
+    // Few candidates: look for them in the postings of the prefix instead of merging these postings.
+    candidates.erase(remove_if(candidates.begin(), candidates.end(), [&prefixPostings](quint32 id) {
+      for (const QVector<quint32> *ids : prefixPostings)
+        if (binary_search(ids->cbegin(), ids->cend(), id))
+          return false;
+      return true;
+    }), candidates.end());
+  } else {
+    QVector<quint32> matches;
+    matches.reserve(prefixPostingsCount);
+    for (const QVector<quint32> *ids : prefixPostings)
+      matches += *ids;
+
+    sort(matches.begin(), matches.end());
+    matches.erase(unique(matches.begin(), matches.end()), matches.end());
+
+    candidates = hasCandidates ? ::intersect(candidates, matches) : matches;
+  }
+
+  // 3. Rank the messages: the last token as a complete word first, then the most recent.
+  candidates.erase(remove_if(candidates.begin(), candidates.end(), [this](quint32 id) {
+    return mDocuments[static_cast<int>(id)].sipAddressId < 0;
+  }), candidates.end());
+
+  const QVector<quint32> wordIds = mPostings.value(prefix);
+  auto isWordMatch = [&wordIds](quint32 id) {
+    return binary_search(wordIds.cbegin(), wordIds.cend(), id);
+  };
+
+  int count = qMin(limit, candidates.count());
+  partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [this, &isWordMatch](quint32 a, quint32 b) {
+    bool aIsWordMatch = isWordMatch(a);
+    if (aIsWordMatch != isWordMatch(b))
+      return aIsWordMatch;
+    return mDocuments[static_cast<int>(a)].timestamp > mDocuments[static_cast<int>(b)].timestamp;
+  });
+
+  QList<Result> results;
+  results.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    const Document &document = mDocuments[static_cast<int>(candidates[i])];
+
+    Result result;
+    result.sipAddress = mSipAddresses[document.sipAddressId];
+    result.timestamp = document.timestamp;
+    result.storageId = document.storageId;
+    results << result;
+  }
+
+  return results;
+}
+
+QString MessageSearchIndex::createSnippet (const QString &text, const QString &pattern) {
+  const QStringList tokens = ::tokenize(pattern);
+
+  // The token is normalized, it can be not found. (Diacritics for example.)
+  int position = tokens.isEmpty() ? 0 : qMax(text.indexOf(tokens.first(), 0, Qt::CaseInsensitive), 0);
+
+  int start = qMax(position - SNIPPET_CONTEXT_LENGTH, 0);
+  QString snippet = text.mid(start, SNIPPET_MAX_LENGTH).simplified();
+
+  if (start > 0)
+    snippet.prepend(QChar(0x2026));
+  if (start + SNIPPET_MAX_LENGTH < text.length())
+    snippet.append(QChar(0x2026));
+
+  return snippet;
+}
+
+// -----------------------------------------------------------------------------
+
+void MessageSearchIndex::addDocument (const Message &message) {
+  auto it = mSipAddressIds.find(message.sipAddress);
+  if (it == mSipAddressIds.end()) {
+    it = mSipAddressIds.insert(message.sipAddress, mSipAddresses.count());
+    mSipAddresses << message.sipAddress;
+  }
+
+  quint32 id = static_cast<quint32>(mDocuments.count());
+
+  Document document;
+  document.sipAddressId = *it;
+  document.timestamp = message.timestamp;
+  document.storageId = message.storageId;
+  mDocuments << document;
+
+  for (const QString &token : ::tokenize(message.text).toSet())
+    mPostings[token] << id;
+}
+
+void MessageSearchIndex::removeDocument (Document &document) {
+  document.sipAddressId = -1;
+  ++mRemovedDocumentsCount;
+}
+
+bool MessageSearchIndex::openJournal (bool reset) {
+  mJournal.close();
+  mJournalRecordsCount = reset ? 0 : mJournalRecordsCount;
+
+  if (!mJournal.open(reset ? QIODevice::WriteOnly | QIODevice::Truncate : QIODevice::WriteOnly | QIODevice::Append))
+    return false;
+
+  if (reset) {
+    QDataStream stream(&mJournal);
+    stream.setVersion(INDEX_STREAM_VERSION);
+    stream << quint32(JOURNAL_MAGIC) << quint32(INDEX_VERSION) << mGeneration;
+    mJournal.flush();
+  }
+
+  return true;
+}
+
+// Returns false if the journal can't be used for the next records.
+bool MessageSearchIndex::replayJournal () {
+  mJournal.close();
+  if (!mJournal.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream stream(&mJournal);
+  stream.setVersion(INDEX_STREAM_VERSION);
+
+  quint32 magic, version, generation;
+  stream >> magic >> version >> generation;
+
+  // A journal of a previous generation is already in the snapshot.
+  if (stream.status() != QDataStream::Ok || magic != JOURNAL_MAGIC || version != INDEX_VERSION || generation != mGeneration) {
+    mJournal.close();
+    return false;
+  }
+
+  int count = 0;
+  qint64 validSize = mJournal.pos();
+
+  while (!stream.atEnd()) {
+    quint8 operation;
+    stream >> operation;
+
+    if (operation == JournalOperationAdd) {
+      Message message;
+      stream >> message.sipAddress >> message.timestamp >> message.storageId >> message.text;
+      if (stream.status() != QDataStream::Ok)
+        break;
+      addDocument(message);
+    } else if (operation == JournalOperationRemoveSipAddress) {
+      QString sipAddress;
+      stream >> sipAddress;
+      if (stream.status() != QDataStream::Ok)
+        break;
+      removeSipAddress(sipAddress, false);
+    } else if (operation == JournalOperationRemoveMessage) {
+      QString sipAddress;
+      quint32 storageId;
+      stream >> sipAddress >> storageId;
+      if (stream.status() != QDataStream::Ok)
+        break;
+      removeMessage(sipAddress, storageId, false);
+    } else
+      break;
+
+    validSize = mJournal.pos();
+    ++count;
+  }
+
+  bool complete = validSize == mJournal.size();
+  mJournal.close();
+
+  // A truncated record can exist after a crash. Drop it.
+  if (!complete) {
+    qWarning() << QStringLiteral("Ignore truncated record of message search journal: `%1`.").arg(mJournal.fileName());
+    if (!mJournal.resize(validSize))
+      return false;
+  }
+
+  mJournalRecordsCount = count;
+  return openJournal(false);
+}
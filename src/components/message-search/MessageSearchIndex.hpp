@@ -0,0 +1,116 @@
+/*
+ * MessageSearchIndex.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef MESSAGE_SEARCH_INDEX_H_
+#define MESSAGE_SEARCH_INDEX_H_
+
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+
+// =============================================================================
+// Inverted index of the chat messages: token => ids of the messages.
+// The texts are not kept: a message is referenced by its storage id
+// in the chat database, where the snippets are read.
+// Persisted on disk in a snapshot. Additions and removals are appended to a
+// journal between two snapshots.
+// Not thread safe: it must be used by one thread at a time.
+// =============================================================================
+
+class MessageSearchIndex {
+public:
+  struct Message {
+    QString sipAddress;
+    qint64 timestamp; // In milliseconds.
+    quint32 storageId;
+    QString text; // Only tokenized.
+  };
+
+  struct Result {
+    QString sipAddress;
+    qint64 timestamp; // In milliseconds.
+    quint32 storageId;
+  };
+
+  MessageSearchIndex (const QString &filePath);
+  ~MessageSearchIndex () = default;
+
+  // Returns false if the index is missing, corrupted or from another version.
+  // In this case, it must be rebuilt.
+  bool load ();
+
+  // Write a new snapshot and reset the journal.
+  bool save ();
+
+  void add (const QList<Message> &messages, bool journaled = true);
+  void removeSipAddress (const QString &sipAddress, bool journaled = true);
+
+  void removeMessage (const QString &sipAddress, quint32 storageId, bool journaled = true);
+  void clear ();
+
+  int getMessagesCount () const {
+    return mDocuments.count() - mRemovedDocumentsCount;
+  }
+
+  bool needsCompaction () const;
+
+  // All tokens of the pattern must match, the last one is a prefix.
+  // Messages where the last token is a complete word are ranked first,
+  // then results are sorted by descending date.
+  QList<Result> search (const QString &pattern, int limit) const;
+
+  // Part of `text` around the first token of `pattern`.
+  static QString createSnippet (const QString &text, const QString &pattern);
+
+private:
+  struct Document {
+    qint32 sipAddressId; // -1 if removed.
+    qint64 timestamp;
+    quint32 storageId;
+  };
+
+  void addDocument (const Message &message);
+  void removeDocument (Document &document);
+  bool openJournal (bool reset);
+  bool replayJournal ();
+
+  QString mFilePath;
+
+  QStringList mSipAddresses;
+  QHash<QString, int> mSipAddressIds;
+
+  QVector<Document> mDocuments;
+  int mRemovedDocumentsCount = 0;
+
+  // Sorted keys, to find the tokens of a prefix.
+  // The ids of a token are in ascending order.
+  QMap<QString, QVector<quint32> > mPostings;
+
+  quint32 mGeneration = 0;
+
+  QFile mJournal;
+  int mJournalRecordsCount = 0;
+};
+
+#endif // MESSAGE_SEARCH_INDEX_H_
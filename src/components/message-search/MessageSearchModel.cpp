@@ -0,0 +1,100 @@
+/*
+ * MessageSearchModel.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include "../core/CoreManager.hpp"
+
+#include "MessageSearchModel.hpp"
+
+// =============================================================================
+
+MessageSearchModel::MessageSearchModel (QObject *parent) : QAbstractListModel(parent) {
+  QObject::connect(
+    CoreManager::getInstance()->getMessageSearchService(), &MessageSearchService::resultsFound,
+    this, &MessageSearchModel::handleResultsFound
+  );
+}
+
+int MessageSearchModel::rowCount (const QModelIndex &) const {
+  return mResults.count();
+}
+
+QHash<int, QByteArray> MessageSearchModel::roleNames () const {
+  QHash<int, QByteArray> roles;
+  roles[Qt::DisplayRole] = "$searchResult";
+  return roles;
+}
+
+QVariant MessageSearchModel::data (const QModelIndex &index, int role) const {
+  int row = index.row();
+
+  if (!index.isValid() || row < 0 || row >= mResults.count())
+    return QVariant();
+
+  if (role == Qt::DisplayRole)
+    return mResults[row];
+
+  return QVariant();
+}
+
+// -----------------------------------------------------------------------------
+
+void MessageSearchModel::setPattern (const QString &pattern) {
+  if (pattern == mPattern)
+    return;
+
+  mPattern = pattern;
+
+  beginResetModel();
+  mResults.clear();
+  endResetModel();
+
+  setQueryId(
+    pattern.trimmed().isEmpty() ? -1 : CoreManager::getInstance()->getMessageSearchService()->search(pattern)
+  );
+
+  emit patternChanged(pattern);
+}
+
+void MessageSearchModel::setQueryId (int queryId) {
+  bool searching = getSearching();
+  mQueryId = queryId;
+
+  if (searching != getSearching())
+    emit searchingChanged(!searching);
+}
+
+// -----------------------------------------------------------------------------
+
+void MessageSearchModel::handleResultsFound (int queryId, const QVariantList &results, bool finished) {
+  if (queryId != mQueryId)
+    return;
+
+  if (!results.isEmpty()) {
+    int row = mResults.count();
+    beginInsertRows(QModelIndex(), row, row + results.count() - 1);
+    mResults += results;
+    endInsertRows();
+  }
+
+  if (finished)
+    setQueryId(-1);
+}
@@ -0,0 +1,72 @@
+/*
+ * MessageSearchModel.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef MESSAGE_SEARCH_MODEL_H_
+#define MESSAGE_SEARCH_MODEL_H_
+
+#include <QAbstractListModel>
+
+// =============================================================================
+// Results of a message search, filled as they are found.
+// =============================================================================
+
+class MessageSearchModel : public QAbstractListModel {
+  Q_OBJECT;
+
+  Q_PROPERTY(QString pattern READ getPattern WRITE setPattern NOTIFY patternChanged);
+  Q_PROPERTY(bool searching READ getSearching NOTIFY searchingChanged);
+
+public:
+  MessageSearchModel (QObject *parent = Q_NULLPTR);
+  ~MessageSearchModel () = default;
+
+  int rowCount (const QModelIndex &index = QModelIndex()) const override;
+
+  QHash<int, QByteArray> roleNames () const override;
+  QVariant data (const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+signals:
+  void patternChanged (const QString &pattern);
+  void searchingChanged (bool searching);
+
+private:
+  QString getPattern () const {
+    return mPattern;
+  }
+
+  void setPattern (const QString &pattern);
+
+  bool getSearching () const {
+    return mQueryId >= 0;
+  }
+
+  void setQueryId (int queryId);
+
+  void handleResultsFound (int queryId, const QVariantList &results, bool finished);
+
+  QString mPattern;
+  int mQueryId = -1;
+
+  QVariantList mResults;
+};
+
+#endif // MESSAGE_SEARCH_MODEL_H_
@@ -0,0 +1,298 @@
+/*
+ * MessageSearchService.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QTimer>
+
+#include "../../app/paths/Paths.hpp"
+#include "../../utils/Utils.hpp"
+#include "../chat/ChatModel.hpp"
+#include "../core/CoreManager.hpp"
+
+#include "MessageSearchService.hpp"
+
+// Number of history messages read on each main loop iteration during a rebuild.
+#define REBUILD_PAGE_SIZE 500
+
+#define MAX_RESULTS_COUNT 200
+#define RESULTS_BATCH_SIZE 50
+
+using namespace std;
+
+// =============================================================================
+
+// The indexed text: the text of the message and the name of its file.
+inline QString getMessageText (const shared_ptr<linphone::ChatMessage> &message) {
+  QString text = ::Utils::coreStringToAppString(message->getText());
+
+  shared_ptr<const linphone::Content> content = message->getFileTransferInformation();
+  if (content)
+    text += ' ' + ::Utils::coreStringToAppString(content->getName());
+
+  return text;
+}
+
+inline MessageSearchIndex::Message toIndexMessage (const shared_ptr<linphone::ChatMessage> &message) {
+  MessageSearchIndex::Message indexMessage;
+  indexMessage.sipAddress = ::Utils::coreStringToAppString(message->getChatRoom()->getPeerAddress()->asStringUriOnly());
+  indexMessage.timestamp = static_cast<qint64>(message->getTime()) * 1000;
+  indexMessage.storageId = message->getStorageId();
+  indexMessage.text = ::getMessageText(message);
+
+  return indexMessage;
+}
+
+// -----------------------------------------------------------------------------
+
+MessageSearchService::MessageSearchService (QObject *parent) : QObject(parent),
+  mIndex(::Utils::coreStringToAppString(Paths::getMessageSearchIndexFilePath())) {
+  // The index is not thread safe: one thread, the tasks are executed in order.
+  mThreadPool.setMaxThreadCount(1);
+
+  QObject::connect(
+    CoreManager::getInstance()->getHandlers().get(), &CoreHandlers::messageReceived,
+    this, &MessageSearchService::handleMessageReceived
+  );
+
+  QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+  QObject::connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher] {
+    handleIndexLoaded(watcher->result());
+    watcher->deleteLater();
+  });
+  watcher->setFuture(QtConcurrent::run(&mThreadPool, [this] {
+    return mIndex.load();
+  }));
+}
+
+MessageSearchService::~MessageSearchService () {
+  // Cancel the pending queries. Additions are already written in the journal.
+  mQueryId.fetchAndAddOrdered(1);
+  mThreadPool.waitForDone();
+}
+
+// -----------------------------------------------------------------------------
+
+void MessageSearchService::connectToChatModel (ChatModel *chatModel) {
+  QObject::connect(chatModel, &ChatModel::messageSent, this, &MessageSearchService::addMessage);
+  QObject::connect(chatModel, &ChatModel::messageRemoved, this, &MessageSearchService::removeMessage);
+
+  QObject::connect(chatModel, &ChatModel::allEntriesRemoved, this, [this, chatModel] {
+    removeSipAddress(chatModel->getSipAddress());
+  });
+}
+
+// -----------------------------------------------------------------------------
+
+int MessageSearchService::search (const QString &pattern) {
+  int queryId = mQueryId.fetchAndAddOrdered(1) + 1;
+
+  QFutureWatcher<QList<MessageSearchIndex::Result> > *watcher = new QFutureWatcher<QList<MessageSearchIndex::Result> >(this);
+  QObject::connect(watcher, &QFutureWatcher<QList<MessageSearchIndex::Result> >::finished, this, [this, watcher, queryId, pattern] {
+    sendResults(queryId, pattern, watcher->result());
+    watcher->deleteLater();
+  });
+  watcher->setFuture(QtConcurrent::run(&mThreadPool, [this, queryId, pattern] {
+    if (queryId != mQueryId.loadAcquire())
+      return QList<MessageSearchIndex::Result>(); // Outdated.
+
+    return mIndex.search(pattern, MAX_RESULTS_COUNT);
+  }));
+
+  return queryId;
+}
+
+// The snippets are read in the chat database, in the main thread: linphone is not thread safe.
+// One batch is read on each main loop iteration.
+void MessageSearchService::sendResults (
+  int queryId,
+  const QString &pattern,
+  const QList<MessageSearchIndex::Result> &results
+) {
+  if (queryId != mQueryId.loadAcquire())
+    return; // Outdated.
+
+  shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
+
+  int count = qMin(results.count(), RESULTS_BATCH_SIZE);
+  QVariantList batch;
+  for (int i = 0; i < count; ++i) {
+    const MessageSearchIndex::Result &result = results[i];
+
+    shared_ptr<linphone::ChatRoom> chatRoom = core->getChatRoomFromUri(::Utils::appStringToCoreString(result.sipAddress));
+    shared_ptr<linphone::ChatMessage> message = chatRoom ? chatRoom->findMessage(result.storageId) : nullptr;
+    if (!message)
+      continue; // Removed since the search.
+
+    QVariantMap map;
+    map["sipAddress"] = result.sipAddress;
+    map["timestamp"] = QDateTime::fromMSecsSinceEpoch(result.timestamp);
+    map["snippet"] = MessageSearchIndex::createSnippet(::getMessageText(message), pattern);
+    batch << map;
+  }
+
+  bool finished = count == results.count();
+  if (!batch.isEmpty() || finished)
+    emit resultsFound(queryId, batch, finished);
+
+  if (!finished) {
+    const QList<MessageSearchIndex::Result> nextResults = results.mid(count);
+    QTimer::singleShot(0, this, [this, queryId, pattern, nextResults] {
+      sendResults(queryId, pattern, nextResults);
+    });
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void MessageSearchService::handleIndexLoaded (bool loaded) {
+  mIndexLoaded = true;
+
+  if (loaded)
+    addMessages(mPendingMessages, true);
+  else
+    startRebuild(); // Pending messages are read with the history.
+
+  mPendingMessages.clear();
+}
+
+void MessageSearchService::handleMessageReceived (const shared_ptr<linphone::ChatMessage> &message) {
+  addMessage(message);
+}
+
+// -----------------------------------------------------------------------------
+
+void MessageSearchService::addMessage (const shared_ptr<linphone::ChatMessage> &message) {
+  MessageSearchIndex::Message indexMessage = ::toIndexMessage(message);
+  if (indexMessage.text.trimmed().isEmpty())
+    return;
+
+  if (!mIndexLoaded) {
+    mPendingMessages << indexMessage;
+    return;
+  }
+
+  if (mRebuildTimer && mRebuildTimer->isActive()) {
+    shared_ptr<linphone::ChatRoom> chatRoom = mRebuildChatRooms.first();
+    if (::Utils::coreStringToAppString(chatRoom->getPeerAddress()->asStringUriOnly()) == indexMessage.sipAddress)
+      ++mRebuildOffset; // The message shifts the history pages.
+    else if (mRebuildSipAddresses.contains(indexMessage.sipAddress))
+      return; // Not yet rebuilt, it will be read with the history.
+  }
+
+  addMessages(QList<MessageSearchIndex::Message>() << indexMessage, true);
+}
+
+void MessageSearchService::addMessages (const QList<MessageSearchIndex::Message> &messages, bool journaled) {
+  if (messages.isEmpty())
+    return;
+
+  QtConcurrent::run(&mThreadPool, [this, messages, journaled] {
+    mIndex.add(messages, journaled);
+    if (journaled && mIndex.needsCompaction())
+      mIndex.save();
+  });
+}
+
+void MessageSearchService::removeSipAddress (const QString &sipAddress) {
+  QtConcurrent::run(&mThreadPool, [this, sipAddress] {
+    mIndex.removeSipAddress(sipAddress);
+    if (mIndex.needsCompaction())
+      mIndex.save();
+  });
+}
+
+void MessageSearchService::removeMessage (const shared_ptr<linphone::ChatMessage> &message) {
+  MessageSearchIndex::Message indexMessage = ::toIndexMessage(message);
+  if (indexMessage.text.trimmed().isEmpty())
+    return;
+
+  // Not yet in the index.
+  for (int i = 0; i < mPendingMessages.count(); ++i) {
+    const MessageSearchIndex::Message &pendingMessage = mPendingMessages[i];
+    if (pendingMessage.sipAddress == indexMessage.sipAddress && pendingMessage.storageId == indexMessage.storageId) {
+      mPendingMessages.removeAt(i);
+      return;
+    }
+  }
+
+  QtConcurrent::run(&mThreadPool, [this, indexMessage] {
+    mIndex.removeMessage(indexMessage.sipAddress, indexMessage.storageId);
+    if (mIndex.needsCompaction())
+      mIndex.save();
+  });
+}
+
+// -----------------------------------------------------------------------------
+
+void MessageSearchService::startRebuild () {
+  for (const auto &chatRoom : CoreManager::getInstance()->getCore()->getChatRooms()) {
+    mRebuildChatRooms << chatRoom;
+    mRebuildSipAddresses << ::Utils::coreStringToAppString(chatRoom->getPeerAddress()->asStringUriOnly());
+  }
+
+  qInfo() << QStringLiteral("Rebuild message search index from %1 chat rooms.").arg(mRebuildChatRooms.count());
+
+  // The history is read in the main thread: linphone is not thread safe.
+  mRebuildOffset = 0;
+  mRebuildTimer = new QTimer(this);
+  mRebuildTimer->setInterval(0);
+  QObject::connect(mRebuildTimer, &QTimer::timeout, this, &MessageSearchService::rebuildNextPage);
+  mRebuildTimer->start();
+}
+
+void MessageSearchService::rebuildNextPage () {
+  if (mRebuildChatRooms.isEmpty()) {
+    mRebuildTimer->stop();
+    mRebuildTimer->deleteLater();
+    mRebuildTimer = nullptr;
+
+    QtConcurrent::run(&mThreadPool, [this] {
+      mIndex.save();
+      qInfo() << QStringLiteral("Message search index rebuilt: %1 messages.").arg(mIndex.getMessagesCount());
+    });
+    return;
+  }
+
+  shared_ptr<linphone::ChatRoom> chatRoom = mRebuildChatRooms.first();
+  list<shared_ptr<linphone::ChatMessage> > history = chatRoom->getHistoryRange(
+      mRebuildOffset, mRebuildOffset + REBUILD_PAGE_SIZE - 1
+    );
+
+  QList<MessageSearchIndex::Message> messages;
+  for (const auto &message : history) {
+    MessageSearchIndex::Message indexMessage = ::toIndexMessage(message);
+    if (!indexMessage.text.trimmed().isEmpty())
+      messages << indexMessage;
+  }
+  addMessages(messages, false);
+
+  int count = static_cast<int>(history.size());
+  mRebuildOffset += count;
+
+  if (count < REBUILD_PAGE_SIZE) {
+    mRebuildSipAddresses.remove(::Utils::coreStringToAppString(chatRoom->getPeerAddress()->asStringUriOnly()));
+    mRebuildChatRooms.removeFirst();
+    mRebuildOffset = 0;
+  }
+}
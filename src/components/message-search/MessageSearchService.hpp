@@ -0,0 +1,91 @@
+/*
+ * MessageSearchService.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef MESSAGE_SEARCH_SERVICE_H_
+#define MESSAGE_SEARCH_SERVICE_H_
+
+#include <linphone++/linphone.hh>
+#include <QAtomicInt>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+#include "MessageSearchIndex.hpp"
+
+// =============================================================================
+// Keeps the message search index up to date and runs the queries.
+// The index is only used in a dedicated worker thread. The snippets
+// of the results are read in the chat database.
+// =============================================================================
+
+class QTimer;
+
+class ChatModel;
+
+class MessageSearchService : public QObject {
+  Q_OBJECT;
+
+public:
+  MessageSearchService (QObject *parent = Q_NULLPTR);
+  ~MessageSearchService ();
+
+  void connectToChatModel (ChatModel *chatModel);
+
+  // Returns the id of the query. The results are provided by `resultsFound`.
+  // A query is not executed if a new one is requested in the meantime.
+  int search (const QString &pattern);
+
+signals:
+  // Results are sent by batches, in the order of `MessageSearchIndex::search`.
+  void resultsFound (int queryId, const QVariantList &results, bool finished);
+
+private:
+  void sendResults (int queryId, const QString &pattern, const QList<MessageSearchIndex::Result> &results);
+
+  void handleIndexLoaded (bool loaded);
+  void handleMessageReceived (const std::shared_ptr<linphone::ChatMessage> &message);
+
+  void addMessage (const std::shared_ptr<linphone::ChatMessage> &message);
+  void addMessages (const QList<MessageSearchIndex::Message> &messages, bool journaled);
+  void removeSipAddress (const QString &sipAddress);
+  void removeMessage (const std::shared_ptr<linphone::ChatMessage> &message);
+
+  void startRebuild ();
+  void rebuildNextPage ();
+
+  MessageSearchIndex mIndex;
+  QThreadPool mThreadPool;
+
+  QAtomicInt mQueryId;
+
+  bool mIndexLoaded = false;
+
+  // Messages received before the index loading.
+  QList<MessageSearchIndex::Message> mPendingMessages;
+
+  QTimer *mRebuildTimer = nullptr;
+  QList<std::shared_ptr<linphone::ChatRoom> > mRebuildChatRooms;
+  QSet<QString> mRebuildSipAddresses;
+  int mRebuildOffset = 0;
+};
+
+#endif // MESSAGE_SEARCH_SERVICE_H_
@@ -275,6 +275,52 @@ void SettingsModel::setFileTransferUrl (const QString &url) {
 
 // -----------------------------------------------------------------------------
 
+// In megabytes, 0 if unlimited.
+int SettingsModel::getFileTransferSizeLimit () const {
+  return mConfig->getInt(UI_SECTION, "file_transfer_size_limit", 500);
+}
+
+void SettingsModel::setFileTransferSizeLimit (int limit) {
+  mConfig->setInt(UI_SECTION, "file_transfer_size_limit", limit);
+  emit fileTransferSizeLimitChanged(limit);
+}
+
+// -----------------------------------------------------------------------------
+
+int SettingsModel::getFileTransferProgressRate () const {
+  return mConfig->getInt(UI_SECTION, "file_transfer_progress_rate", 10);
+}
+
+void SettingsModel::setFileTransferProgressRate (int rate) {
+  mConfig->setInt(UI_SECTION, "file_transfer_progress_rate", rate);
+  emit fileTransferProgressRateChanged(rate);
+}
+
+// -----------------------------------------------------------------------------
+
+int SettingsModel::getMaxConcurrentDownloads () const {
+  return mConfig->getInt(UI_SECTION, "max_concurrent_downloads", 3);
+}
+
+void SettingsModel::setMaxConcurrentDownloads (int count) {
+  mConfig->setInt(UI_SECTION, "max_concurrent_downloads", count);
+  emit maxConcurrentDownloadsChanged(count);
+}
+
+// -----------------------------------------------------------------------------
+
+// Max number of entries loaded by the hidden chats kept in memory.
+int SettingsModel::getChatModelsCacheMaxEntries () const {
+  return mConfig->getInt(UI_SECTION, "chat_models_cache_max_entries", 2000);
+}
+
+void SettingsModel::setChatModelsCacheMaxEntries (int count) {
+  mConfig->setInt(UI_SECTION, "chat_models_cache_max_entries", count);
+  emit chatModelsCacheMaxEntriesChanged(count);
+}
+
+// -----------------------------------------------------------------------------
+
 bool SettingsModel::getLimeIsSupported () const {
   return CoreManager::getInstance()->getCore()->limeAvailable();
 }
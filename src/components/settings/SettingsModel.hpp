@@ -67,6 +67,11 @@ class SettingsModel : public QObject {
   Q_PROPERTY(int autoAnswerDelay READ getAutoAnswerDelay WRITE setAutoAnswerDelay NOTIFY autoAnswerDelayChanged);
 
   Q_PROPERTY(QString fileTransferUrl READ getFileTransferUrl WRITE setFileTransferUrl NOTIFY fileTransferUrlChanged);
+  Q_PROPERTY(int fileTransferSizeLimit READ getFileTransferSizeLimit WRITE setFileTransferSizeLimit NOTIFY fileTransferSizeLimitChanged);
+  Q_PROPERTY(int fileTransferProgressRate READ getFileTransferProgressRate WRITE setFileTransferProgressRate NOTIFY fileTransferProgressRateChanged);
+  Q_PROPERTY(int maxConcurrentDownloads READ getMaxConcurrentDownloads WRITE setMaxConcurrentDownloads NOTIFY maxConcurrentDownloadsChanged);
+
+  Q_PROPERTY(int chatModelsCacheMaxEntries READ getChatModelsCacheMaxEntries WRITE setChatModelsCacheMaxEntries NOTIFY chatModelsCacheMaxEntriesChanged);
 
   Q_PROPERTY(bool limeIsSupported READ getLimeIsSupported CONSTANT);
   Q_PROPERTY(QVariantList supportedMediaEncryptions READ getSupportedMediaEncryptions CONSTANT);
@@ -193,6 +198,18 @@ public:
   QString getFileTransferUrl () const;
   void setFileTransferUrl (const QString &url);
 
+  int getFileTransferSizeLimit () const;
+  void setFileTransferSizeLimit (int limit);
+
+  int getFileTransferProgressRate () const;
+  void setFileTransferProgressRate (int rate);
+
+  int getMaxConcurrentDownloads () const;
+  void setMaxConcurrentDownloads (int count);
+
+  int getChatModelsCacheMaxEntries () const;
+  void setChatModelsCacheMaxEntries (int count);
+
   bool getLimeIsSupported () const;
   QVariantList getSupportedMediaEncryptions () const;
 
@@ -312,6 +329,11 @@ signals:
   void autoAnswerDelayChanged (int delay);
 
   void fileTransferUrlChanged (const QString &url);
+  void fileTransferSizeLimitChanged (int limit);
+  void fileTransferProgressRateChanged (int rate);
+  void maxConcurrentDownloadsChanged (int count);
+
+  void chatModelsCacheMaxEntriesChanged (int count);
 
   void mediaEncryptionChanged (MediaEncryption encryption);
   void limeStateChanged (LimeState state);
@@ -24,10 +24,16 @@
 
 // =============================================================================
 
-SipAddressObserver::SipAddressObserver (const QString &sipAddress) {
+SipAddressObserver::SipAddressObserver (const QString &sipAddress, QObject *parent) : QObject(parent) {
   mSipAddress = sipAddress;
 }
 
+void SipAddressObserver::unref () {
+  Q_ASSERT(mRefCount > 0);
+  if (--mRefCount == 0)
+    emit released();
+}
+
 void SipAddressObserver::setContact (ContactModel *contact) {
   if (contact == mContact)
     return;
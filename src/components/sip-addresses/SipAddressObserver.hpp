@@ -27,19 +27,15 @@
 
 // =============================================================================
 
+// Shared by all the users of a sip address, see `SipAddressObserverHandle`.
 class SipAddressObserver : public QObject {
   friend class SipAddressesModel;
+  friend class SipAddressObserverHandle;
 
   Q_OBJECT;
 
-  Q_PROPERTY(QString sipAddress READ getSipAddress CONSTANT);
-
-  Q_PROPERTY(ContactModel * contact READ getContact NOTIFY contactChanged);
-  Q_PROPERTY(Presence::PresenceStatus presenceStatus READ getPresenceStatus NOTIFY presenceStatusChanged);
-  Q_PROPERTY(int unreadMessagesCount READ getUnreadMessagesCount NOTIFY unreadMessagesCountChanged);
-
 public:
-  SipAddressObserver (const QString &sipAddress);
+  SipAddressObserver (const QString &sipAddress, QObject *parent = Q_NULLPTR);
   ~SipAddressObserver () = default;
 
 signals:
@@ -47,7 +43,22 @@ signals:
   void presenceStatusChanged (const Presence::PresenceStatus &presenceStatus);
   void unreadMessagesCountChanged (int unreadMessagesCount);
 
+  // Emitted when the last handle is destroyed.
+  void released ();
+
 private:
+  void ref () {
+    ++mRefCount;
+  }
+
+  void unref ();
+
+  int getRefCount () const {
+    return mRefCount;
+  }
+
+  // ---------------------------------------------------------------------------
+
   QString getSipAddress () const {
     return mSipAddress;
   }
@@ -81,6 +92,8 @@ private:
   ContactModel *mContact = nullptr;
   Presence::PresenceStatus mPresenceStatus = Presence::PresenceStatus::Offline;
   int mUnreadMessagesCount = 0;
+
+  int mRefCount = 0;
 };
 
 Q_DECLARE_METATYPE(SipAddressObserver *);
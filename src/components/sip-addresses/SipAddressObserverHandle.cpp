@@ -0,0 +1,43 @@
+/*
+ * SipAddressObserverHandle.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include "SipAddressObserverHandle.hpp"
+
+// =============================================================================
+
+SipAddressObserverHandle::SipAddressObserverHandle (SipAddressObserver *observer) {
+  Q_ASSERT(observer != nullptr);
+
+  mSipAddress = observer->getSipAddress();
+  mObserver = observer;
+
+  observer->ref();
+
+  QObject::connect(observer, &SipAddressObserver::contactChanged, this, &SipAddressObserverHandle::contactChanged);
+  QObject::connect(observer, &SipAddressObserver::presenceStatusChanged, this, &SipAddressObserverHandle::presenceStatusChanged);
+  QObject::connect(observer, &SipAddressObserver::unreadMessagesCountChanged, this, &SipAddressObserverHandle::unreadMessagesCountChanged);
+}
+
+SipAddressObserverHandle::~SipAddressObserverHandle () {
+  if (mObserver)
+    mObserver->unref();
+}
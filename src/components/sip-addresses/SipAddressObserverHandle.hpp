@@ -0,0 +1,77 @@
+/*
+ * SipAddressObserverHandle.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef SIP_ADDRESS_OBSERVER_HANDLE_H_
+#define SIP_ADDRESS_OBSERVER_HANDLE_H_
+
+#include <QPointer>
+
+#include "SipAddressObserver.hpp"
+
+// =============================================================================
+
+// A QML reference on a shared `SipAddressObserver`.
+// The observer is released when the last handle is destroyed.
+class SipAddressObserverHandle : public QObject {
+  Q_OBJECT;
+
+  Q_PROPERTY(QString sipAddress READ getSipAddress CONSTANT);
+
+  Q_PROPERTY(ContactModel * contact READ getContact NOTIFY contactChanged);
+  Q_PROPERTY(Presence::PresenceStatus presenceStatus READ getPresenceStatus NOTIFY presenceStatusChanged);
+  Q_PROPERTY(int unreadMessagesCount READ getUnreadMessagesCount NOTIFY unreadMessagesCountChanged);
+
+public:
+  SipAddressObserverHandle (SipAddressObserver *observer);
+  ~SipAddressObserverHandle ();
+
+signals:
+  void contactChanged (ContactModel *contact);
+  void presenceStatusChanged (const Presence::PresenceStatus &presenceStatus);
+  void unreadMessagesCountChanged (int unreadMessagesCount);
+
+private:
+  QString getSipAddress () const {
+    return mSipAddress;
+  }
+
+  ContactModel *getContact () const {
+    return mObserver ? mObserver->getContact() : nullptr;
+  }
+
+  Presence::PresenceStatus getPresenceStatus () const {
+    return mObserver ? mObserver->getPresenceStatus() : Presence::PresenceStatus::Offline;
+  }
+
+  int getUnreadMessagesCount () const {
+    return mObserver ? mObserver->getUnreadMessagesCount() : 0;
+  }
+
+  QString mSipAddress;
+
+  // Null if the observers owner is destroyed before the handle.
+  QPointer<SipAddressObserver> mObserver;
+};
+
+Q_DECLARE_METATYPE(SipAddressObserverHandle *);
+
+#endif // SIP_ADDRESS_OBSERVER_HANDLE_H_
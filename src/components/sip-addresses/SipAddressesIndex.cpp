@@ -0,0 +1,183 @@
+/*
+ * SipAddressesIndex.cpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtDebug>
+
+#include "SipAddressesIndex.hpp"
+
+// Bump the version on each format change.
+#define INDEX_MAGIC 0x4c534149 // `LSAI`.
+#define INDEX_VERSION 1
+
+// Offset of the clean flag: magic (4 bytes) + version (4 bytes).
+#define INDEX_CLEAN_FLAG_OFFSET 8
+
+#define INDEX_STREAM_VERSION QDataStream::Qt_5_0
+
+// =============================================================================
+
+SipAddressesIndex::SipAddressesIndex (const QString &filePath, const QStringList &databaseFilePaths) {
+  mFilePath = filePath;
+  mDatabaseFilePaths = databaseFilePaths;
+}
+
+// -----------------------------------------------------------------------------
+
+bool SipAddressesIndex::load () {
+  mEntries.clear();
+
+  QFile file(mFilePath);
+  if (!file.open(QIODevice::ReadOnly) || file.size() == 0) {
+    qInfo() << QStringLiteral("No sip addresses index found: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream.setVersion(INDEX_STREAM_VERSION);
+
+  quint32 magic, version;
+  bool clean;
+  stream >> magic >> version >> clean;
+
+  if (stream.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION) {
+    qWarning() << QStringLiteral("Ignore invalid sip addresses index: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  if (!clean) {
+    qWarning() << QStringLiteral("Ignore stale sip addresses index: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  // The databases can be modified without the app, by another version for example.
+  QList<qint64> databaseStamps;
+  stream >> databaseStamps;
+
+  if (stream.status() != QDataStream::Ok || databaseStamps != getDatabaseStamps()) {
+    qWarning() << QStringLiteral("Ignore outdated sip addresses index: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  quint32 count;
+  stream >> count;
+
+  mEntries.reserve(static_cast<int>(count));
+  for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+    QString sipAddress;
+    qint64 timestamp;
+    qint32 unreadMessagesCount;
+
+    stream >> sipAddress >> timestamp >> unreadMessagesCount;
+
+    Entry &entry = mEntries[sipAddress];
+    entry.timestamp = timestamp;
+    entry.unreadMessagesCount = unreadMessagesCount;
+  }
+
+  if (stream.status() != QDataStream::Ok) {
+    qWarning() << QStringLiteral("Ignore corrupted sip addresses index: `%1`.").arg(mFilePath);
+    mEntries.clear();
+    return false;
+  }
+
+  qInfo() << QStringLiteral("Sip addresses index loaded: %1 entries.").arg(count);
+
+  return true;
+}
+
+void SipAddressesIndex::markAsDirty () {
+  QFile file(mFilePath);
+  if (!file.open(QIODevice::ReadWrite) || file.size() <= INDEX_CLEAN_FLAG_OFFSET)
+    return;
+
+  if (!file.seek(INDEX_CLEAN_FLAG_OFFSET) || !file.putChar(0))
+    qWarning() << QStringLiteral("Unable to mark sip addresses index as dirty: `%1`.").arg(mFilePath);
+}
+
+bool SipAddressesIndex::save () {
+  // Write in a temporary file, the old index is replaced only on success.
+  QSaveFile file(mFilePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << QStringLiteral("Unable to open sip addresses index: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream.setVersion(INDEX_STREAM_VERSION);
+
+  stream << quint32(INDEX_MAGIC) << quint32(INDEX_VERSION) << true;
+  stream << getDatabaseStamps();
+  stream << static_cast<quint32>(mEntries.count());
+
+  for (auto it = mEntries.cbegin(); it != mEntries.cend(); ++it)
+    stream << it.key() << it->timestamp << static_cast<qint32>(it->unreadMessagesCount);
+
+  if (stream.status() != QDataStream::Ok || !file.commit()) {
+    qWarning() << QStringLiteral("Unable to save sip addresses index: `%1`.").arg(mFilePath);
+    return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void SipAddressesIndex::setEntry (const QString &sipAddress, const Entry &entry) {
+  mEntries[sipAddress] = entry;
+}
+
+void SipAddressesIndex::setTimestamp (const QString &sipAddress, qint64 timestamp) {
+  mEntries[sipAddress].timestamp = timestamp;
+}
+
+void SipAddressesIndex::setUnreadMessagesCount (const QString &sipAddress, int unreadMessagesCount) {
+  auto it = mEntries.find(sipAddress);
+  if (it != mEntries.end())
+    it->unreadMessagesCount = unreadMessagesCount;
+}
+
+void SipAddressesIndex::remove (const QString &sipAddress) {
+  mEntries.remove(sipAddress);
+}
+
+void SipAddressesIndex::clear () {
+  mEntries.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+QList<qint64> SipAddressesIndex::getDatabaseStamps () const {
+  QList<qint64> stamps;
+  for (const auto &databaseFilePath : mDatabaseFilePaths) {
+    QFileInfo info(databaseFilePath);
+    if (info.exists())
+      stamps << info.size() << info.lastModified().toMSecsSinceEpoch();
+    else
+      stamps << -1 << -1;
+  }
+  return stamps;
+}
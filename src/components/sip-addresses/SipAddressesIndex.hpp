@@ -0,0 +1,77 @@
+/*
+ * SipAddressesIndex.hpp
+ * Copyright (C) 2017  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 17, 2026
+ *      Author: agent
+ */
+
+#ifndef SIP_ADDRESSES_INDEX_H_
+#define SIP_ADDRESSES_INDEX_H_
+
+#include <QHash>
+#include <QStringList>
+
+// =============================================================================
+// Last activity (message or call) of each sip address with history.
+// Persisted on disk to avoid fetching all chat histories at startup.
+// =============================================================================
+
+class SipAddressesIndex {
+public:
+  struct Entry {
+    qint64 timestamp; // In milliseconds.
+    int unreadMessagesCount;
+  };
+
+  // The size and the modification time of the databases are saved with the index.
+  SipAddressesIndex (const QString &filePath, const QStringList &databaseFilePaths);
+  ~SipAddressesIndex () = default;
+
+  // Returns false if the index is missing, corrupted, from another version,
+  // was not saved on a clean shutdown or if a database was modified since
+  // the save. In this case, it must be rebuilt.
+  bool load ();
+
+  // Flag the index on disk as stale until the next `save` call.
+  // So a crash forces a rebuild on the next startup.
+  void markAsDirty ();
+
+  bool save ();
+
+  const QHash<QString, Entry> &getEntries () const {
+    return mEntries;
+  }
+
+  void setEntry (const QString &sipAddress, const Entry &entry);
+  void setTimestamp (const QString &sipAddress, qint64 timestamp);
+  void setUnreadMessagesCount (const QString &sipAddress, int unreadMessagesCount);
+
+  void remove (const QString &sipAddress);
+  void clear ();
+
+private:
+  // Size and modification time of each database, -1 if missing.
+  QList<qint64> getDatabaseStamps () const;
+
+  QString mFilePath;
+  QStringList mDatabaseFilePaths;
+
+  QHash<QString, Entry> mEntries;
+};
+
+#endif // SIP_ADDRESSES_INDEX_H_
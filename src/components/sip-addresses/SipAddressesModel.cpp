@@ -20,10 +20,15 @@
  *      Author: Ronan Abhamon
  */
 
+#include <algorithm>
+#include <type_traits>
+
 #include <QDateTime>
-#include <QSet>
+#include <QTimer>
 #include <QtDebug>
 
+#include "../../app/logger/Logger.hpp"
+#include "../../app/paths/Paths.hpp"
 #include "../../utils/LinphoneUtils.hpp"
 #include "../../utils/Utils.hpp"
 #include "../chat/ChatModel.hpp"
@@ -31,19 +36,54 @@
 
 #include "SipAddressesModel.hpp"
 
+// About one frame at 60 fps.
+#define FLUSH_CHANGES_INTERVAL 16
+
+#define LOG_STATS_INTERVAL 1000
+
 using namespace std;
 
 // =============================================================================
 
-SipAddressesModel::SipAddressesModel (QObject *parent) : QAbstractListModel(parent) {
+// The duration can be wrong if status is not success.
+inline qint64 getCallLogTimestamp (const shared_ptr<linphone::CallLog> &callLog) {
+  return callLog->getStatus() == linphone::CallStatus::CallStatusSuccess
+    ? (callLog->getStartDate() + callLog->getDuration()) * 1000
+    : callLog->getStartDate() * 1000;
+}
+
+// -----------------------------------------------------------------------------
+
+SipAddressesModel::SipAddressesModel (QObject *parent) :
+  QAbstractListModel(parent),
+  mIndex(
+    ::Utils::coreStringToAppString(Paths::getSipAddressesIndexFilePath()),
+    QStringList({
+      ::Utils::coreStringToAppString(Paths::getMessageHistoryFilePath()),
+      ::Utils::coreStringToAppString(Paths::getCallHistoryFilePath())
+    })
+  ) {
+  mFlushTimer = new QTimer(this);
+  mFlushTimer->setSingleShot(true);
+  mFlushTimer->setInterval(FLUSH_CHANGES_INTERVAL);
+  QObject::connect(mFlushTimer, &QTimer::timeout, this, &SipAddressesModel::flushChanges);
+
   initSipAddresses();
 
+  if (Logger::getInstance()->isVerbose()) {
+    QTimer *statsTimer = new QTimer(this);
+    statsTimer->setInterval(LOG_STATS_INTERVAL);
+    QObject::connect(statsTimer, &QTimer::timeout, this, &SipAddressesModel::logStats);
+    statsTimer->start();
+  }
+
   mCoreHandlers = CoreManager::getInstance()->getHandlers();
 
   ContactsListModel *contacts = CoreManager::getInstance()->getContactsListModel();
 
   QObject::connect(contacts, &ContactsListModel::contactAdded, this, &SipAddressesModel::handleContactAdded);
   QObject::connect(contacts, &ContactsListModel::contactRemoved, this, &SipAddressesModel::handleContactRemoved);
+  QObject::connect(contacts, &ContactsListModel::contactsImported, this, &SipAddressesModel::handleContactsImported);
 
   QObject::connect(contacts, &ContactsListModel::sipAddressAdded, this, &SipAddressesModel::handleSipAddressAdded);
   QObject::connect(contacts, &ContactsListModel::sipAddressRemoved, this, &SipAddressesModel::handleSipAddressRemoved);
@@ -54,26 +94,51 @@ SipAddressesModel::SipAddressesModel (QObject *parent) : QAbstractListModel(pare
   QObject::connect(intHandlers, &CoreHandlers::presenceReceived, this, &SipAddressesModel::handlePresenceReceived);
 }
 
+SipAddressesModel::~SipAddressesModel () {
+  mIndex.save();
+}
+
 // -----------------------------------------------------------------------------
 
 int SipAddressesModel::rowCount (const QModelIndex &) const {
-  return mRefs.count();
+  return mEntries.count();
 }
 
 QHash<int, QByteArray> SipAddressesModel::roleNames () const {
   QHash<int, QByteArray> roles;
-  roles[Qt::DisplayRole] = "$sipAddress";
+  roles[Roles::SipAddressEntryRole] = "$sipAddress";
+  roles[Roles::SipAddressRole] = "$sipAddressUri";
+  roles[Roles::ContactRole] = "$contact";
+  roles[Roles::PresenceStatusRole] = "$presenceStatus";
+  roles[Roles::UnreadMessagesCountRole] = "$unreadMessagesCount";
+  roles[Roles::TimestampRole] = "$timestamp";
   return roles;
 }
 
 QVariant SipAddressesModel::data (const QModelIndex &index, int role) const {
   int row = index.row();
 
-  if (!index.isValid() || row < 0 || row >= mRefs.count())
+  if (!index.isValid() || row < 0 || row >= mEntries.count())
     return QVariant();
 
-  if (role == Qt::DisplayRole)
-    return QVariant::fromValue(*mRefs[row]);
+  const SipAddressEntry &entry = mEntries[row];
+
+  switch (role) {
+    case Roles::SipAddressEntryRole:
+      return entry.toVariantMap();
+    case Roles::SipAddressRole:
+      return entry.sipAddress;
+    case Roles::ContactRole:
+      return QVariant::fromValue(entry.getContact());
+    case Roles::PresenceStatusRole:
+      return entry.presenceReceived ? QVariant::fromValue(entry.presenceStatus) : QVariant();
+    case Roles::UnreadMessagesCountRole:
+      return entry.unreadMessagesCount;
+    case Roles::TimestampRole:
+      return entry.timestamp;
+    case Roles::ContactUsernameRole:
+      return entry.getContactUsername();
+  }
 
   return QVariant();
 }
@@ -95,47 +160,43 @@ void SipAddressesModel::connectToChatModel (ChatModel *chatModel) {
 // -----------------------------------------------------------------------------
 
 QVariantMap SipAddressesModel::find (const QString &sipAddress) const {
-  auto it = mSipAddresses.find(sipAddress);
-  return it == mSipAddresses.end() ? QVariantMap() : *it;
+  int row = findRow(sipAddress);
+  return row == -1 ? QVariantMap() : mEntries[row].toVariantMap();
 }
 
 // -----------------------------------------------------------------------------
 
 ContactModel *SipAddressesModel::mapSipAddressToContact (const QString &sipAddress) const {
-  auto it = mSipAddresses.find(sipAddress);
-  if (it == mSipAddresses.end())
-    return nullptr;
-
-  return it->value("contact").value<ContactModel *>();
+  int row = findRow(sipAddress);
+  return row == -1 ? nullptr : mEntries[row].getContact();
 }
 
 // -----------------------------------------------------------------------------
 
-SipAddressObserver *SipAddressesModel::getSipAddressObserver (const QString &sipAddress) {
-  SipAddressObserver *model = new SipAddressObserver(sipAddress);
-
-  {
-    auto it = mSipAddresses.find(sipAddress);
-    if (it != mSipAddresses.end()) {
-      model->setContact(it->value("contact").value<ContactModel *>());
-      model->setPresenceStatus(
-        it->value("presenceStatus", Presence::PresenceStatus::Offline).value<Presence::PresenceStatus>()
-      );
-      model->setUnreadMessagesCount(
-        it->value("unreadMessagesCount", 0).toInt()
-      );
+SipAddressObserverHandle *SipAddressesModel::getSipAddressObserver (const QString &sipAddress) {
+  SipAddressObserver *observer = mObservers.value(sipAddress);
+
+  if (!observer) {
+    observer = new SipAddressObserver(sipAddress, this);
+
+    int row = findRow(sipAddress);
+    if (row != -1) {
+      const SipAddressEntry &entry = mEntries[row];
+      observer->setContact(entry.getContact());
+      observer->setPresenceStatus(entry.presenceStatus);
+      observer->setUnreadMessagesCount(entry.unreadMessagesCount);
     }
-  }
 
-  mObservers.insert(sipAddress, model);
-  QObject::connect(
-    model, &SipAddressObserver::destroyed, this, [this, model]() {
-      const QString sipAddress = model->getSipAddress();
-      if (mObservers.remove(sipAddress, model) == 0)
-        qWarning() << QStringLiteral("Unable to remove sip address `%1` from observers.").arg(sipAddress);
+    mObservers[sipAddress] = observer;
+    QObject::connect(observer, &SipAddressObserver::released, this, [this, observer] {
+      handleObserverReleased(observer);
     });
 
-  return model;
+    emit observersCountChanged(mObservers.count());
+  }
+
+  // Owned by QML, the observer is released with the last handle.
+  return new SipAddressObserverHandle(observer);
 }
 
 // -----------------------------------------------------------------------------
@@ -197,6 +258,46 @@ bool SipAddressesModel::sipAddressIsValid (const QString &sipAddress) {
 
 // -----------------------------------------------------------------------------
 
+ContactModel *SipAddressesModel::SipAddressEntry::getContact () const {
+  if (hasLazyContact) {
+    contact = CoreManager::getInstance()->getContactsListModel()->findContactModelFromSipAddress(sipAddress);
+    hasLazyContact = false;
+  }
+
+  return contact;
+}
+
+QVariant SipAddressesModel::SipAddressEntry::getContactUsername () const {
+  if (contact)
+    return contact->getVcardModel()->getUsername();
+
+  if (hasLazyContact) {
+    const QString username = CoreManager::getInstance()->getContactsListModel()->findUsernameFromSipAddress(sipAddress);
+    if (!username.isNull())
+      return username;
+  }
+
+  return QVariant();
+}
+
+QVariantMap SipAddressesModel::SipAddressEntry::toVariantMap () const {
+  QVariantMap map;
+  map["sipAddress"] = sipAddress;
+
+  if (timestamp)
+    map["timestamp"] = QDateTime::fromMSecsSinceEpoch(timestamp);
+  if (hasContact())
+    map["contact"] = QVariant::fromValue(getContact());
+  if (presenceReceived)
+    map["presenceStatus"] = presenceStatus;
+
+  map["unreadMessagesCount"] = unreadMessagesCount;
+
+  return map;
+}
+
+// -----------------------------------------------------------------------------
+
 bool SipAddressesModel::removeRow (int row, const QModelIndex &parent) {
   return removeRows(row, 1, parent);
 }
@@ -204,19 +305,24 @@ bool SipAddressesModel::removeRow (int row, const QModelIndex &parent) {
 bool SipAddressesModel::removeRows (int row, int count, const QModelIndex &parent) {
   int limit = row + count - 1;
 
-  if (row < 0 || count < 0 || limit >= mSipAddresses.count())
+  if (row < 0 || count < 0 || limit >= mEntries.count())
     return false;
 
   beginRemoveRows(parent, row, limit);
 
-  for (int i = 0; i < count; ++i) {
-    const QVariantMap *map = mRefs.takeAt(row);
-    QString sipAddress = (*map)["sipAddress"].toString();
+  for (int i = row; i <= limit; ++i) {
+    const QString &sipAddress = mEntries[i].sipAddress;
 
     qInfo() << QStringLiteral("Remove sip address: `%1`.").arg(sipAddress);
-    mSipAddresses.remove(sipAddress);
+    mRows.remove(sipAddress);
   }
 
+  mEntries.remove(row, count);
+
+  // Shift the rows of the next entries.
+  for (int i = row; i < mEntries.count(); ++i)
+    mRows[mEntries[i].sipAddress] = i;
+
   endRemoveRows();
 
   return true;
@@ -224,6 +330,33 @@ bool SipAddressesModel::removeRows (int row, int count, const QModelIndex &paren
 
 // -----------------------------------------------------------------------------
 
+int SipAddressesModel::getObserverReferencesCount () const {
+  int count = 0;
+  for (const auto &observer : mObservers)
+    count += observer->getRefCount();
+  return count;
+}
+
+void SipAddressesModel::handleObserverReleased (SipAddressObserver *observer) {
+  const QString sipAddress = observer->getSipAddress();
+  if (mObservers.value(sipAddress) != observer) {
+    qWarning() << QStringLiteral("Unable to remove sip address `%1` from observers.").arg(sipAddress);
+    return;
+  }
+
+  // Removed now, so a new caller gets a new observer and never this one.
+  mObservers.remove(sipAddress);
+  mPendingPresenceStatuses.remove(sipAddress);
+  mPendingUnreadMessagesCounts.remove(sipAddress);
+
+  // Not deleted immediately, the release can be triggered by one of its signals.
+  observer->deleteLater();
+
+  emit observersCountChanged(mObservers.count());
+}
+
+// -----------------------------------------------------------------------------
+
 void SipAddressesModel::handleContactAdded (ContactModel *contact) {
   for (const auto &sipAddress : contact->getVcardModel()->getSipAddresses())
     addOrUpdateSipAddress(sipAddress.toString(), contact);
@@ -234,6 +367,55 @@ void SipAddressesModel::handleContactRemoved (const ContactModel *contact) {
     removeContactOfSipAddress(sipAddress.toString());
 }
 
+// Imported contacts are mapped like the contacts of the startup, with one insertion.
+void SipAddressesModel::handleContactsImported (const QStringList &sipAddresses) {
+  QStringList newSipAddresses;
+  QSet<QString> done;
+
+  for (const auto &sipAddress : sipAddresses) {
+    if (done.contains(sipAddress))
+      continue;
+    done.insert(sipAddress);
+
+    int row = findRow(sipAddress);
+    if (row == -1) {
+      newSipAddresses << sipAddress;
+      continue;
+    }
+
+    SipAddressEntry &entry = mEntries[row];
+    if (entry.hasContact())
+      continue;
+
+    entry.hasLazyContact = true;
+    if (mObservers.contains(sipAddress))
+      updateObservers(sipAddress, entry.getContact());
+    signalEntryChanged(row, true);
+  }
+
+  if (newSipAddresses.isEmpty())
+    return;
+
+  int row = mEntries.count();
+  beginInsertRows(QModelIndex(), row, row + newSipAddresses.count() - 1);
+
+  for (const auto &sipAddress : newSipAddresses) {
+    qInfo() << QStringLiteral("Add sip address: `%1`.").arg(sipAddress);
+
+    SipAddressEntry entry;
+    entry.sipAddress = sipAddress;
+    entry.hasLazyContact = true;
+
+    mRows[entry.sipAddress] = mEntries.count();
+    mEntries << entry;
+
+    if (mObservers.contains(sipAddress))
+      updateObservers(sipAddress, mEntries.last().getContact());
+  }
+
+  endInsertRows();
+}
+
 void SipAddressesModel::handleSipAddressAdded (ContactModel *contact, const QString &sipAddress) {
   ContactModel *mappedContact = mapSipAddressToContact(sipAddress);
   if (mappedContact) {
@@ -294,38 +476,57 @@ void SipAddressesModel::handlePresenceReceived (
       break;
   }
 
-  auto it = mSipAddresses.find(sipAddress);
-  if (it != mSipAddresses.end()) {
+  int row = findRow(sipAddress);
+  if (row != -1) {
     qInfo() << QStringLiteral("Update presence of `%1`: %2.").arg(sipAddress).arg(status);
-    (*it)["presenceStatus"] = status;
 
-    int row = mRefs.indexOf(&(*it));
-    Q_ASSERT(row != -1);
-    emit dataChanged(index(row, 0), index(row, 0));
+    SipAddressEntry &entry = mEntries[row];
+    entry.presenceStatus = status;
+    entry.presenceReceived = true;
+
+    signalEntryChanged(row);
   }
 
   updateObservers(sipAddress, status);
 }
 
 void SipAddressesModel::handleAllEntriesRemoved (const QString &sipAddress) {
-  auto it = mSipAddresses.find(sipAddress);
-  if (it == mSipAddresses.end()) {
+  int row = findRow(sipAddress);
+  if (row == -1) {
     qWarning() << QStringLiteral("Unable to found sip address: `%1`.").arg(sipAddress);
     return;
   }
 
-  int row = mRefs.indexOf(&(*it));
-  Q_ASSERT(row != -1);
+  // The displayed calls are removed with the messages, see `ChatModel::removeAllEntries`.
+  // The last other one, if any, is the new activity of the sip address.
+  qint64 timestamp = 0;
 
-  // No history, no contact => Remove sip address from list.
-  if (!it->contains("contact")) {
-    removeRow(row);
-    return;
+  shared_ptr<linphone::Address> address = linphone::Factory::get()->createAddress(
+      ::Utils::appStringToCoreString(sipAddress)
+    );
+  if (address)
+    for (const auto &callLog : CoreManager::getInstance()->getCore()->getCallHistoryForAddress(address))
+      if (callLog->getStatus() == linphone::CallStatusEarlyAborted)
+        timestamp = qMax(timestamp, ::getCallLogTimestamp(callLog));
+
+  SipAddressEntry &entry = mEntries[row];
+  entry.timestamp = timestamp;
+  entry.unreadMessagesCount = 0;
+
+  if (timestamp > 0)
+    mIndex.setEntry(sipAddress, { timestamp, 0 });
+  else {
+    mIndex.remove(sipAddress);
+
+    // No history, no contact => Remove sip address from list.
+    if (!entry.hasContact()) {
+      removeRow(row);
+      return;
+    }
   }
 
   // Signal changes.
-  it->remove("timestamp");
-  emit dataChanged(index(row, 0), index(row, 0));
+  signalEntryChanged(row);
 }
 
 void SipAddressesModel::handleMessageSent (const shared_ptr<linphone::ChatMessage> &message) {
@@ -336,13 +537,12 @@ void SipAddressesModel::handleMessageSent (const shared_ptr<linphone::ChatMessag
 }
 
 void SipAddressesModel::handleMessagesCountReset (const QString &sipAddress) {
-  auto it = mSipAddresses.find(sipAddress);
-  if (it != mSipAddresses.end()) {
-    (*it)["unreadMessagesCount"] = 0;
+  int row = findRow(sipAddress);
+  if (row != -1) {
+    mEntries[row].unreadMessagesCount = 0;
+    mIndex.setUnreadMessagesCount(sipAddress, 0);
 
-    int row = mRefs.indexOf(&(*it));
-    Q_ASSERT(row != -1);
-    emit dataChanged(index(row, 0), index(row, 0));
+    signalEntryChanged(row);
   }
 
   updateObservers(sipAddress, 0);
@@ -350,59 +550,57 @@ void SipAddressesModel::handleMessagesCountReset (const QString &sipAddress) {
 
 // -----------------------------------------------------------------------------
 
-void SipAddressesModel::addOrUpdateSipAddress (QVariantMap &map, ContactModel *contact) {
-  QString sipAddress = map["sipAddress"].toString();
+void SipAddressesModel::addOrUpdateSipAddress (SipAddressEntry &entry, ContactModel *contact) {
+  if (!contact && !entry.hasContact())
+    qWarning() << QStringLiteral("`contact` field is empty on sip address: `%1`.").arg(entry.sipAddress);
 
-  if (contact)
-    map["contact"] = QVariant::fromValue(contact);
-  else if (map.remove("contact") == 0)
-    qWarning() << QStringLiteral("`contact` field is empty on sip address: `%1`.").arg(sipAddress);
+  entry.contact = contact;
+  entry.hasLazyContact = false;
 
-  updateObservers(sipAddress, contact);
+  updateObservers(entry.sipAddress, contact);
 }
 
-void SipAddressesModel::addOrUpdateSipAddress (QVariantMap &map, const shared_ptr<linphone::Call> &call) {
-  const shared_ptr<linphone::CallLog> callLog = call->getCallLog();
+void SipAddressesModel::addOrUpdateSipAddress (SipAddressEntry &entry, const shared_ptr<linphone::Call> &call) {
+  qint64 timestamp = ::getCallLogTimestamp(call->getCallLog());
 
-  map["timestamp"] = callLog->getStatus() == linphone::CallStatus::CallStatusSuccess
-    ? QDateTime::fromMSecsSinceEpoch((callLog->getStartDate() + callLog->getDuration()) * 1000)
-    : QDateTime::fromMSecsSinceEpoch(callLog->getStartDate() * 1000);
+  entry.timestamp = timestamp;
+  mIndex.setTimestamp(entry.sipAddress, timestamp);
 }
 
-void SipAddressesModel::addOrUpdateSipAddress (QVariantMap &map, const shared_ptr<linphone::ChatMessage> &message) {
+void SipAddressesModel::addOrUpdateSipAddress (SipAddressEntry &entry, const shared_ptr<linphone::ChatMessage> &message) {
   int count = message->getChatRoom()->getUnreadMessagesCount();
+  qint64 timestamp = message->getTime() * 1000;
+
+  entry.timestamp = timestamp;
+  entry.unreadMessagesCount = count;
 
-  map["timestamp"] = QDateTime::fromMSecsSinceEpoch(message->getTime() * 1000);
-  map["unreadMessagesCount"] = count;
+  mIndex.setEntry(entry.sipAddress, { timestamp, count });
 
-  updateObservers(map["sipAddress"].toString(), count);
+  updateObservers(entry.sipAddress, count);
 }
 
 template<typename T>
 void SipAddressesModel::addOrUpdateSipAddress (const QString &sipAddress, T data) {
-  auto it = mSipAddresses.find(sipAddress);
-  if (it != mSipAddresses.end()) {
-    addOrUpdateSipAddress(*it, data);
-
-    int row = mRefs.indexOf(&(*it));
-    Q_ASSERT(row != -1);
-    emit dataChanged(index(row, 0), index(row, 0));
+  int row = findRow(sipAddress);
+  if (row != -1) {
+    addOrUpdateSipAddress(mEntries[row], data);
+    signalEntryChanged(row, is_same<T, ContactModel *>::value);
 
     return;
   }
 
-  QVariantMap map;
-  map["sipAddress"] = sipAddress;
-  addOrUpdateSipAddress(map, data);
+  SipAddressEntry entry;
+  entry.sipAddress = sipAddress;
+  addOrUpdateSipAddress(entry, data);
 
-  int row = mRefs.count();
+  row = mEntries.count();
 
   beginInsertRows(QModelIndex(), row, row);
 
   qInfo() << QStringLiteral("Add sip address: `%1`.").arg(sipAddress);
 
-  mSipAddresses[sipAddress] = map;
-  mRefs << &mSipAddresses[sipAddress];
+  mEntries << entry;
+  mRows[entry.sipAddress] = row;
 
   endInsertRows();
 }
@@ -410,8 +608,8 @@ void SipAddressesModel::addOrUpdateSipAddress (const QString &sipAddress, T data
 // -----------------------------------------------------------------------------
 
 void SipAddressesModel::removeContactOfSipAddress (const QString &sipAddress) {
-  auto it = mSipAddresses.find(sipAddress);
-  if (it == mSipAddresses.end()) {
+  int row = findRow(sipAddress);
+  if (row == -1) {
     qWarning() << QStringLiteral("Unable to remove unavailable sip address: `%1`.").arg(sipAddress);
     return;
   }
@@ -421,14 +619,12 @@ void SipAddressesModel::removeContactOfSipAddress (const QString &sipAddress) {
   updateObservers(sipAddress, contactModel);
 
   qInfo() << QStringLiteral("Map new contact on sip address: `%1`.").arg(sipAddress) << contactModel;
-  addOrUpdateSipAddress(*it, contactModel);
-
-  int row = mRefs.indexOf(&(*it));
-  Q_ASSERT(row != -1);
+  SipAddressEntry &entry = mEntries[row];
+  addOrUpdateSipAddress(entry, contactModel);
 
   // History exists, signal changes.
-  if (it->contains("timestamp") || contactModel) {
-    emit dataChanged(index(row, 0), index(row, 0));
+  if (entry.timestamp || contactModel) {
+    signalEntryChanged(row, true);
     return;
   }
 
@@ -436,9 +632,151 @@ void SipAddressesModel::removeContactOfSipAddress (const QString &sipAddress) {
   removeRow(row);
 }
 
+void SipAddressesModel::signalEntryChanged (int row, bool immediate) {
+  ++mEntryChangesCount;
+
+  if (immediate) {
+    // Pending changes of this row are included.
+    mDirtySipAddresses.remove(mEntries[row].sipAddress);
+
+    emit dataChanged(index(row, 0), index(row, 0));
+
+    ++mDataChangedCount;
+    mDataChangedReceiversCount += receivers(SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)));
+    return;
+  }
+
+  mDirtySipAddresses << mEntries[row].sipAddress;
+  if (!mFlushTimer->isActive())
+    mFlushTimer->start();
+}
+
+void SipAddressesModel::flushChanges () {
+  // 1. Signal minimal ranges of changed rows.
+  // Rows are resolved now because they can be shifted by a removal.
+  QVector<int> rows;
+  rows.reserve(mDirtySipAddresses.count());
+  for (const auto &sipAddress : mDirtySipAddresses) {
+    int row = findRow(sipAddress);
+    if (row != -1)
+      rows << row;
+  }
+  mDirtySipAddresses.clear();
+
+  sort(rows.begin(), rows.end());
+
+  int receiversCount = receivers(SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)));
+  for (int i = 0, count = rows.count(); i < count;) {
+    int first = rows[i];
+    int last = first;
+    while (++i < count && rows[i] == last + 1)
+      ++last;
+
+    emit dataChanged(index(first, 0), index(last, 0));
+
+    ++mDataChangedCount;
+    mDataChangedReceiversCount += receiversCount;
+  }
+
+  // 2. Update observers.
+  // Copies, a handle can be destroyed by a binding update.
+  const QHash<QString, Presence::PresenceStatus> presenceStatuses = mPendingPresenceStatuses;
+  mPendingPresenceStatuses.clear();
+  for (auto it = presenceStatuses.cbegin(); it != presenceStatuses.cend(); ++it) {
+    SipAddressObserver *observer = mObservers.value(it.key());
+    if (observer)
+      observer->setPresenceStatus(*it);
+  }
+
+  const QHash<QString, int> unreadMessagesCounts = mPendingUnreadMessagesCounts;
+  mPendingUnreadMessagesCounts.clear();
+  for (auto it = unreadMessagesCounts.cbegin(); it != unreadMessagesCounts.cend(); ++it) {
+    SipAddressObserver *observer = mObservers.value(it.key());
+    if (observer)
+      observer->setUnreadMessagesCount(*it);
+  }
+}
+
+void SipAddressesModel::logStats () {
+  int observersCount = mObservers.count();
+  int observerReferencesCount = getObserverReferencesCount();
+  if (observersCount != mLoggedObserversCount || observerReferencesCount != mLoggedObserverReferencesCount) {
+    qInfo() << QStringLiteral("Sip address observers: %1 for %2 references.")
+      .arg(observersCount).arg(observerReferencesCount);
+
+    mLoggedObserversCount = observersCount;
+    mLoggedObserverReferencesCount = observerReferencesCount;
+  }
+
+  if (mEntryChangesCount == 0)
+    return;
+
+  qInfo() << QStringLiteral("Sip addresses changes: %1/s, dataChanged signals: %2/s, dataChanged receivers: %3/s.")
+    .arg(mEntryChangesCount).arg(mDataChangedCount).arg(mDataChangedReceiversCount);
+
+  mEntryChangesCount = 0;
+  mDataChangedCount = 0;
+  mDataChangedReceiversCount = 0;
+}
+
+// -----------------------------------------------------------------------------
+
 void SipAddressesModel::initSipAddresses () {
+  if (!mIndex.load())
+    initSipAddressesFromCore();
+
+  // The index is saved at exit. Until then, a crash must invalidate it.
+  mIndex.markAsDirty();
+
+  const QHash<QString, SipAddressesIndex::Entry> &indexEntries = mIndex.getEntries();
+  mEntries.reserve(indexEntries.count());
+  mRows.reserve(indexEntries.count());
+
+  for (auto it = indexEntries.cbegin(); it != indexEntries.cend(); ++it) {
+    qInfo() << QStringLiteral("Add sip address: `%1`.").arg(it.key());
+
+    SipAddressEntry entry;
+    entry.sipAddress = it.key();
+    entry.timestamp = it->timestamp;
+    entry.unreadMessagesCount = it->unreadMessagesCount;
+
+    mRows[entry.sipAddress] = mEntries.count();
+    mEntries << entry;
+  }
+
+  // Get sip addresses from contacts. Their models are created on first access.
+  const QMultiHash<QString, ContactsListModel::ContactEntry *> &contacts =
+    CoreManager::getInstance()->getContactsListModel()->mContactsBySipAddress;
+
+  for (auto it = contacts.cbegin(); it != contacts.cend(); ++it) {
+    int row = findRow(it.key());
+    if (row != -1) {
+      mEntries[row].hasLazyContact = true;
+      continue;
+    }
+
+    qInfo() << QStringLiteral("Add sip address: `%1`.").arg(it.key());
+
+    SipAddressEntry entry;
+    entry.sipAddress = it.key();
+    entry.hasLazyContact = true;
+
+    mRows[entry.sipAddress] = mEntries.count();
+    mEntries << entry;
+  }
+
+  // No view is bound yet, nothing to signal.
+  mDirtySipAddresses.clear();
+  mEntryChangesCount = 0;
+}
+
+void SipAddressesModel::initSipAddressesFromCore () {
+  qInfo() << QStringLiteral("Rebuild sip addresses index.");
+
   shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
 
+  mIndex.clear();
+
   // Get sip addresses from chatrooms.
   for (const auto &chatRoom : core->getChatRooms()) {
     list<shared_ptr<linphone::ChatMessage> > history = chatRoom->getHistory(0);
@@ -446,14 +784,10 @@ void SipAddressesModel::initSipAddresses () {
     if (history.size() == 0)
       continue;
 
-    QString sipAddress = ::Utils::coreStringToAppString(chatRoom->getPeerAddress()->asStringUriOnly());
-
-    QVariantMap map;
-    map["sipAddress"] = sipAddress;
-    map["timestamp"] = QDateTime::fromMSecsSinceEpoch(history.back()->getTime() * 1000);
-    map["unreadMessagesCount"] = chatRoom->getUnreadMessagesCount();
-
-    mSipAddresses[sipAddress] = map;
+    mIndex.setEntry(
+      ::Utils::coreStringToAppString(chatRoom->getPeerAddress()->asStringUriOnly()),
+      { history.back()->getTime() * 1000, chatRoom->getUnreadMessagesCount() }
+    );
   }
 
   // Get sip addresses from calls.
@@ -469,42 +803,42 @@ void SipAddressesModel::initSipAddresses () {
 
     addressDone << sipAddress;
 
-    QVariantMap map;
-    map["sipAddress"] = sipAddress;
-
-    // The duration can be wrong if status is not success.
-    map["timestamp"] = callLog->getStatus() == linphone::CallStatus::CallStatusSuccess
-      ? QDateTime::fromMSecsSinceEpoch((callLog->getStartDate() + callLog->getDuration()) * 1000)
-      : QDateTime::fromMSecsSinceEpoch(callLog->getStartDate() * 1000);
+    qint64 timestamp = ::getCallLogTimestamp(callLog);
 
-    auto it = mSipAddresses.find(sipAddress);
-    if (it == mSipAddresses.end() || map["timestamp"] > (*it)["timestamp"])
-      mSipAddresses[sipAddress] = map;
+    const QHash<QString, SipAddressesIndex::Entry> &entries = mIndex.getEntries();
+    auto it = entries.find(sipAddress);
+    if (it == entries.cend() || timestamp > it->timestamp)
+      mIndex.setTimestamp(sipAddress, timestamp);
   }
 
-  for (const auto &map : mSipAddresses) {
-    qInfo() << QStringLiteral("Add sip address: `%1`.").arg(map["sipAddress"].toString());
-    mRefs << &map;
-  }
-
-  // Get sip addresses from contacts.
-  for (auto &contact : CoreManager::getInstance()->getContactsListModel()->mList)
-    handleContactAdded(contact);
+  mIndex.save();
 }
 
 // -----------------------------------------------------------------------------
 
 void SipAddressesModel::updateObservers (const QString &sipAddress, ContactModel *contact) {
-  for (auto &observer : mObservers.values(sipAddress))
+  SipAddressObserver *observer = mObservers.value(sipAddress);
+  if (observer)
     observer->setContact(contact);
 }
 
+// Presence and messages count updates are applied with the next flush.
+// Contact updates are immediate, a contact can be destroyed before.
+
 void SipAddressesModel::updateObservers (const QString &sipAddress, const Presence::PresenceStatus &presenceStatus) {
-  for (auto &observer : mObservers.values(sipAddress))
-    observer->setPresenceStatus(presenceStatus);
+  if (!mObservers.contains(sipAddress))
+    return;
+
+  mPendingPresenceStatuses[sipAddress] = presenceStatus;
+  if (!mFlushTimer->isActive())
+    mFlushTimer->start();
 }
 
 void SipAddressesModel::updateObservers (const QString &sipAddress, int messagesCount) {
-  for (auto &observer : mObservers.values(sipAddress))
-    observer->setUnreadMessagesCount(messagesCount);
+  if (!mObservers.contains(sipAddress))
+    return;
+
+  mPendingUnreadMessagesCounts[sipAddress] = messagesCount;
+  if (!mFlushTimer->isActive())
+    mFlushTimer->start();
 }
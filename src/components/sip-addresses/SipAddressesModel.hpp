@@ -24,22 +24,39 @@
 #define SIP_ADDRESSES_MODEL_H_
 
 #include <QAbstractListModel>
+#include <QSet>
 #include <QUrl>
+#include <QVector>
 
 #include "../chat/ChatModel.hpp"
 #include "../contact/ContactModel.hpp"
-#include "SipAddressObserver.hpp"
+#include "SipAddressObserverHandle.hpp"
+#include "SipAddressesIndex.hpp"
 
 // =============================================================================
 
 class CoreHandlers;
+class QTimer;
 
 class SipAddressesModel : public QAbstractListModel {
   Q_OBJECT;
 
+  // Live shared observers, one per observed sip address.
+  Q_PROPERTY(int observersCount READ getObserversCount NOTIFY observersCountChanged);
+
 public:
+  enum Roles {
+    SipAddressEntryRole = Qt::DisplayRole,
+    SipAddressRole = Qt::UserRole,
+    ContactRole,
+    PresenceStatusRole,
+    UnreadMessagesCountRole,
+    TimestampRole,
+    ContactUsernameRole // Invalid if no contact. The contact model is not created.
+  };
+
   SipAddressesModel (QObject *parent = Q_NULLPTR);
-  ~SipAddressesModel () = default;
+  ~SipAddressesModel ();
 
   int rowCount (const QModelIndex &index = QModelIndex()) const override;
 
@@ -50,7 +67,7 @@ public:
 
   Q_INVOKABLE QVariantMap find (const QString &sipAddress) const;
   Q_INVOKABLE ContactModel *mapSipAddressToContact (const QString &sipAddress) const;
-  Q_INVOKABLE SipAddressObserver *getSipAddressObserver (const QString &sipAddress);
+  Q_INVOKABLE SipAddressObserverHandle *getSipAddressObserver (const QString &sipAddress);
 
   // ---------------------------------------------------------------------------
   // Sip addresses helpers.
@@ -66,7 +83,20 @@ public:
 
   // ---------------------------------------------------------------------------
 
+signals:
+  void observersCountChanged (int count);
+
 private:
+  int getObserversCount () const {
+    return mObservers.count();
+  }
+
+  int getObserverReferencesCount () const;
+
+  void handleObserverReleased (SipAddressObserver *observer);
+
+  // ---------------------------------------------------------------------------
+
   bool removeRow (int row, const QModelIndex &parent = QModelIndex());
   bool removeRows (int row, int count, const QModelIndex &parent = QModelIndex()) override;
 
@@ -74,6 +104,7 @@ private:
 
   void handleContactAdded (ContactModel *contact);
   void handleContactRemoved (const ContactModel *contact);
+  void handleContactsImported (const QStringList &sipAddresses);
 
   void handleSipAddressAdded (ContactModel *contact, const QString &sipAddress);
   void handleSipAddressRemoved (ContactModel *contact, const QString &sipAddress);
@@ -90,9 +121,29 @@ private:
 
   // A sip address exists in this list if a contact is linked to it, or a call, or a message.
 
-  void addOrUpdateSipAddress (QVariantMap &map, ContactModel *contact);
-  void addOrUpdateSipAddress (QVariantMap &map, const std::shared_ptr<linphone::Call> &call);
-  void addOrUpdateSipAddress (QVariantMap &map, const std::shared_ptr<linphone::ChatMessage> &message);
+  struct SipAddressEntry {
+    QString sipAddress; // Shared with the `mRows` key.
+    qint64 timestamp = 0; // Last activity in milliseconds. 0 if no history.
+
+    // Set at startup, the contact is created on first access.
+    mutable bool hasLazyContact = false;
+    mutable ContactModel *contact = nullptr;
+    Presence::PresenceStatus presenceStatus = Presence::PresenceStatus::Offline;
+    int unreadMessagesCount = 0;
+    bool presenceReceived = false;
+
+    bool hasContact () const {
+      return contact || hasLazyContact;
+    }
+
+    ContactModel *getContact () const;
+    QVariant getContactUsername () const;
+    QVariantMap toVariantMap () const;
+  };
+
+  void addOrUpdateSipAddress (SipAddressEntry &entry, ContactModel *contact);
+  void addOrUpdateSipAddress (SipAddressEntry &entry, const std::shared_ptr<linphone::Call> &call);
+  void addOrUpdateSipAddress (SipAddressEntry &entry, const std::shared_ptr<linphone::ChatMessage> &message);
 
   template<class T>
   void addOrUpdateSipAddress (const QString &sipAddress, T data);
@@ -101,16 +152,42 @@ private:
 
   void removeContactOfSipAddress (const QString &sipAddress);
 
+  int findRow (const QString &sipAddress) const {
+    return mRows.value(sipAddress, -1);
+  }
+
+  // Changes are coalesced and signaled once per frame.
+  // Contact changes are signaled immediately: the previous contact can be destroyed.
+  void signalEntryChanged (int row, bool immediate = false);
+  void flushChanges ();
+
+  void logStats ();
+
   void initSipAddresses ();
+  void initSipAddressesFromCore ();
 
   void updateObservers (const QString &sipAddress, ContactModel *contact);
   void updateObservers (const QString &sipAddress, const Presence::PresenceStatus &presenceStatus);
   void updateObservers (const QString &sipAddress, int messagesCount);
 
-  QHash<QString, QVariantMap> mSipAddresses;
-  QList<const QVariantMap *> mRefs;
+  QVector<SipAddressEntry> mEntries;
+  QHash<QString, int> mRows;
+
+  QHash<QString, SipAddressObserver *> mObservers;
+
+  QSet<QString> mDirtySipAddresses;
+  QHash<QString, Presence::PresenceStatus> mPendingPresenceStatuses;
+  QHash<QString, int> mPendingUnreadMessagesCounts;
+  QTimer *mFlushTimer;
+
+  // Stats, logged each second in verbose mode.
+  int mEntryChangesCount = 0;
+  int mDataChangedCount = 0;
+  int mDataChangedReceiversCount = 0; // Sum of the connected receivers of each signal.
+  int mLoggedObserversCount = 0;
+  int mLoggedObserverReferencesCount = 0;
 
-  QMultiHash<QString, SipAddressObserver *> mObservers;
+  SipAddressesIndex mIndex;
 
   std::shared_ptr<CoreHandlers> mCoreHandlers;
 };
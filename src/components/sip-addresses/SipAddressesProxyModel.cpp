@@ -30,87 +30,198 @@
 #define WEIGHT_POS_3 2
 #define WEIGHT_POS_OTHER 1
 
+// Word offsets greater than this value have the same weight.
+#define MAX_WORD_OFFSET 4
+
+using namespace std;
+
 // =============================================================================
 
-const QRegExp SipAddressesProxyModel::mSearchSeparators("^[^_.-;@ ][_.-;@ ]");
+inline bool isSearchSeparator (QChar c) {
+  switch (c.unicode()) {
+    case '_':
+    case '.':
+    case '-':
+    case ';':
+    case '@':
+    case ' ':
+      return true;
+    default:
+      break;
+  }
+
+  return false;
+}
 
 // -----------------------------------------------------------------------------
 
 SipAddressesProxyModel::SipAddressesProxyModel (QObject *parent) : QSortFilterProxyModel(parent) {
-  setSourceModel(CoreManager::getInstance()->getSipAddressesModel());
+  CoreManager *coreManager = CoreManager::getInstance();
+
+  // A username can be changed without sip address update.
+  QObject::connect(
+    coreManager->getContactsListModel(), &ContactsListModel::contactUpdated,
+    this, &SipAddressesProxyModel::handleContactUpdated
+  );
+
+  // Connected before `setSourceModel`: the rows data must be updated
+  // before the proxy filters and sorts the changed rows.
+  SipAddressesModel *sipAddressesModel = coreManager->getSipAddressesModel();
+  QObject::connect(
+    sipAddressesModel, &SipAddressesModel::rowsInserted,
+    this, &SipAddressesProxyModel::handleSourceRowsInserted
+  );
+  QObject::connect(
+    sipAddressesModel, &SipAddressesModel::rowsRemoved,
+    this, &SipAddressesProxyModel::handleSourceRowsRemoved
+  );
+  QObject::connect(
+    sipAddressesModel, &SipAddressesModel::modelReset,
+    this, &SipAddressesProxyModel::handleSourceModelReset
+  );
+  QObject::connect(
+    sipAddressesModel, &SipAddressesModel::dataChanged,
+    this, &SipAddressesProxyModel::handleSourceDataChanged
+  );
+
+  setSourceModel(sipAddressesModel);
+  handleSourceModelReset();
+
   sort(0);
 }
 
 // -----------------------------------------------------------------------------
 
 void SipAddressesProxyModel::setFilter (const QString &pattern) {
-  mFilter = pattern;
-  invalidate();
+  const QString filter = pattern.toLower();
+  if (filter == mFilter)
+    return;
+
+  // Narrow the search if the new filter contains the previous one.
+  bool narrowed = !mFilter.isEmpty() && filter.contains(mFilter);
+  mFilter = filter;
+
+  updateWeights(narrowed);
 }
 
 // -----------------------------------------------------------------------------
 
-bool SipAddressesProxyModel::filterAcceptsRow (int sourceRow, const QModelIndex &sourceParent) const {
-  const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-  return computeEntryWeight(index.data().toMap()) > 0;
+bool SipAddressesProxyModel::filterAcceptsRow (int sourceRow, const QModelIndex &) const {
+  return mRows[sourceRow].weight > 0;
 }
 
 bool SipAddressesProxyModel::lessThan (const QModelIndex &left, const QModelIndex &right) const {
-  const QVariantMap mapA = sourceModel()->data(left).toMap();
-  const QVariantMap mapB = sourceModel()->data(right).toMap();
-
-  const QString sipAddressA = mapA["sipAddress"].toString();
-  const QString sipAddressB = mapB["sipAddress"].toString();
-
-  // TODO: Use a cache, do not compute the same value as `filterAcceptsRow`.
-  int weightA = computeEntryWeight(mapA);
-  int weightB = computeEntryWeight(mapB);
+  const RowData &rowDataA = mRows[left.row()];
+  const RowData &rowDataB = mRows[right.row()];
 
   // 1. Not the same weight.
-  if (weightA != weightB)
-    return weightA > weightB;
-
-  const ContactModel *contactA = mapA.value("contact").value<ContactModel *>();
-  const ContactModel *contactB = mapB.value("contact").value<ContactModel *>();
+  if (rowDataA.weight != rowDataB.weight)
+    return rowDataA.weight > rowDataB.weight;
 
   // 2. No contacts.
-  if (!contactA && !contactB)
-    return sipAddressA <= sipAddressB;
+  if (!rowDataA.hasContact && !rowDataB.hasContact)
+    return rowDataA.sipAddress <= rowDataB.sipAddress;
 
   // 3. No contact for a or b.
-  if (!contactA || !contactB)
-    return !!contactA;
+  if (!rowDataA.hasContact || !rowDataB.hasContact)
+    return rowDataA.hasContact;
 
-  // 4. Same contact (address).
-  if (contactA == contactB)
-    return sipAddressA <= sipAddressB;
-
-  // 5. Not the same contact name.
-  int diff = contactA->mLinphoneFriend->getName().compare(contactB->mLinphoneFriend->getName());
+  // 4. Not the same contact name.
+  int diff = rowDataA.contactUsername.compare(rowDataB.contactUsername);
   if (diff)
     return diff <= 0;
 
-  // 6. Same contact name, so compare sip addresses.
-  return sipAddressA <= sipAddressB;
+  // 5. Same contact name (or same contact), so compare sip addresses.
+  return rowDataA.sipAddress <= rowDataB.sipAddress;
+}
+
+// -----------------------------------------------------------------------------
+
+SipAddressesProxyModel::RowData SipAddressesProxyModel::createRowData (int sourceRow) const {
+  const QModelIndex index = sourceModel()->index(sourceRow, 0);
+
+  // The contact models are not created: only the visible rows need them.
+  const QVariant contactUsername = index.data(SipAddressesModel::ContactUsernameRole);
+
+  RowData rowData;
+  rowData.sipAddress = index.data(SipAddressesModel::SipAddressRole).toString();
+  rowData.contactUsername = contactUsername.toString();
+  rowData.hasContact = contactUsername.isValid();
+  rowData.hasSearchKeys = false;
+  rowData.weight = 0;
+
+  return rowData;
+}
+
+bool SipAddressesProxyModel::updateContactUsername (RowData &rowData, int sourceRow) {
+  const QVariant contactUsername = sourceModel()->index(sourceRow, 0).data(SipAddressesModel::ContactUsernameRole);
+  if (contactUsername.isValid() == rowData.hasContact && contactUsername.toString() == rowData.contactUsername)
+    return false;
+
+  rowData.contactUsername = contactUsername.toString();
+  rowData.hasContact = contactUsername.isValid();
+  if (rowData.hasSearchKeys)
+    rowData.usernameKey = createSearchKey(rowData.contactUsername);
+
+  rowData.weight = computeRowWeight(rowData);
+
+  return true;
+}
+
+void SipAddressesProxyModel::updateWeights (bool narrowed) {
+  bool filterChanged = false;
+  bool orderChanged = false;
+
+  for (auto &rowData : mRows) {
+    int weight = rowData.weight;
+    if (narrowed && weight == 0)
+      continue;
+
+    rowData.weight = computeRowWeight(rowData);
+    if (rowData.weight == weight)
+      continue;
+
+    if (weight > 0 && rowData.weight > 0)
+      orderChanged = true;
+    else
+      filterChanged = true;
+  }
+
+  // The order of the accepted rows is kept if their weights are the same.
+  if (orderChanged)
+    invalidate();
+  else if (filterChanged)
+    invalidateFilter();
 }
 
-int SipAddressesProxyModel::computeEntryWeight (const QVariantMap &entry) const {
-  int weight = computeStringWeight(entry["sipAddress"].toString().mid(4));
+// -----------------------------------------------------------------------------
+
+int SipAddressesProxyModel::computeRowWeight (RowData &rowData) const {
+  // The empty filter matches at the start of all strings.
+  if (mFilter.isEmpty())
+    return rowData.hasContact ? 2 * WEIGHT_POS_0 : WEIGHT_POS_0;
 
-  const ContactModel *contact = entry.value("contact").value<ContactModel *>();
-  if (contact)
-    weight += computeStringWeight(contact->getVcardModel()->getUsername());
+  if (!rowData.hasSearchKeys) {
+    rowData.sipAddressKey = createSearchKey(rowData.sipAddress.mid(4));
+    rowData.usernameKey = createSearchKey(rowData.contactUsername);
+    rowData.hasSearchKeys = true;
+  }
+
+  int weight = computeStringWeight(rowData.sipAddressKey);
+
+  if (rowData.hasContact)
+    weight += computeStringWeight(rowData.usernameKey);
 
   return weight;
 }
 
-int SipAddressesProxyModel::computeStringWeight (const QString &string) const {
+int SipAddressesProxyModel::computeStringWeight (const SearchKey &key) const {
   int index = -1;
   int offset = -1;
 
-  while ((index = string.indexOf(mFilter, index + 1, Qt::CaseInsensitive)) != -1) {
-    int tmpOffset = index - string.lastIndexOf(mSearchSeparators, index) - 1;
-    if ((tmpOffset != -1 && tmpOffset < offset) || offset == -1)
+  while ((index = key.text.indexOf(mFilter, index + 1)) != -1) {
+    int tmpOffset = key.wordOffsets.at(index);
+    if (tmpOffset < offset || offset == -1)
       if ((offset = tmpOffset) == 0) break;
   }
 
@@ -125,3 +236,69 @@ int SipAddressesProxyModel::computeStringWeight (const QString &string) const {
 
   return WEIGHT_POS_OTHER;
 }
+
+// -----------------------------------------------------------------------------
+
+// The source model is not changed, so the view must be updated here.
+void SipAddressesProxyModel::handleContactUpdated () {
+  bool changed = false;
+  for (int row = 0; row < mRows.count(); ++row)
+    changed |= updateContactUsername(mRows[row], row);
+
+  if (changed)
+    invalidate();
+}
+
+void SipAddressesProxyModel::handleSourceRowsInserted (const QModelIndex &, int first, int last) {
+  mRows.insert(first, last - first + 1, RowData());
+  for (int row = first; row <= last; ++row) {
+    RowData &rowData = mRows[row];
+    rowData = createRowData(row);
+    rowData.weight = computeRowWeight(rowData);
+  }
+}
+
+void SipAddressesProxyModel::handleSourceRowsRemoved (const QModelIndex &, int first, int last) {
+  mRows.remove(first, last - first + 1);
+}
+
+void SipAddressesProxyModel::handleSourceModelReset () {
+  mRows.clear();
+
+  int count = sourceModel()->rowCount();
+  mRows.reserve(count);
+  for (int row = 0; row < count; ++row) {
+    mRows << createRowData(row);
+    mRows.last().weight = computeRowWeight(mRows.last());
+  }
+}
+
+// Only the contact username can change the weight of a row.
+void SipAddressesProxyModel::handleSourceDataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+  for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+    updateContactUsername(mRows[row], row);
+}
+
+// -----------------------------------------------------------------------------
+
+SipAddressesProxyModel::SearchKey SipAddressesProxyModel::createSearchKey (const QString &string) {
+  SearchKey key;
+  key.text = string.toLower();
+
+  // One more offset for the empty pattern which matches at the end.
+  int length = key.text.length();
+  key.wordOffsets.resize(length + 1);
+
+  char offset = 0;
+  for (int i = 0; i < length; ++i) {
+    key.wordOffsets[i] = offset;
+
+    if (::isSearchSeparator(key.text[i]))
+      offset = 0;
+    else if (offset < MAX_WORD_OFFSET)
+      ++offset;
+  }
+  key.wordOffsets[length] = offset;
+
+  return key;
+}
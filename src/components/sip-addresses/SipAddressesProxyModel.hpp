@@ -24,6 +24,7 @@
 #define SIP_ADDRESSES_PROXY_MODEL_H_
 
 #include <QSortFilterProxyModel>
+#include <QVector>
 
 // =============================================================================
 
@@ -41,12 +42,52 @@ protected:
   bool lessThan (const QModelIndex &left, const QModelIndex &right) const override;
 
 private:
-  int computeEntryWeight (const QVariantMap &entry) const;
-  int computeStringWeight (const QString &string) const;
+  // A lowercased string with the offset of each char in its word.
+  struct SearchKey {
+    QString text;
+    QByteArray wordOffsets;
+  };
 
-  QString mFilter;
+  // Sort and search data of one row of the source model.
+  // The username is `SipAddressesModel::ContactUsernameRole`, empty if no contact.
+  struct RowData {
+    QString sipAddress;
+    QString contactUsername;
+    bool hasContact;
 
-  static const QRegExp mSearchSeparators;
+    // Built with the first not empty filter.
+    bool hasSearchKeys;
+    SearchKey sipAddressKey;
+    SearchKey usernameKey;
+
+    int weight;
+  };
+
+  RowData createRowData (int sourceRow) const;
+
+  // Returns true if the username of the row was changed.
+  bool updateContactUsername (RowData &rowData, int sourceRow);
+
+  // Recomputes the weights of all the rows with the current filter, then updates the view.
+  // If `narrowed`, the filter extends the previous one: a row which did not match can't match now.
+  void updateWeights (bool narrowed);
+
+  int computeRowWeight (RowData &rowData) const;
+  int computeStringWeight (const SearchKey &key) const;
+
+  void handleContactUpdated ();
+
+  void handleSourceRowsInserted (const QModelIndex &parent, int first, int last);
+  void handleSourceRowsRemoved (const QModelIndex &parent, int first, int last);
+  void handleSourceModelReset ();
+  void handleSourceDataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+  static SearchKey createSearchKey (const QString &string);
+
+  QString mFilter; // Lowercased.
+
+  // Indexed by source row, updated before the proxy handles the source changes.
+  QVector<RowData> mRows;
 };
 
 #endif // SIP_ADDRESSES_PROXY_MODEL_H_
@@ -20,17 +20,32 @@
  *      Author: Ronan Abhamon
  */
 
-#include <QDateTime>
+#include <algorithm>
 
 #include "../core/CoreManager.hpp"
 
 #include "TimelineModel.hpp"
 
+using namespace std;
+
 // =============================================================================
 
-TimelineModel::TimelineModel (QObject *parent) : QSortFilterProxyModel(parent) {
-  setSourceModel(CoreManager::getInstance()->getSipAddressesModel());
-  sort(0);
+TimelineModel::TimelineModel (QObject *parent) : QAbstractListModel(parent) {
+  mSipAddressesModel = CoreManager::getInstance()->getSipAddressesModel();
+
+  QObject::connect(mSipAddressesModel, &SipAddressesModel::dataChanged, this, &TimelineModel::handleSourceDataChanged);
+  QObject::connect(mSipAddressesModel, &SipAddressesModel::rowsInserted, this, &TimelineModel::handleSourceRowsInserted);
+  QObject::connect(
+    mSipAddressesModel, &SipAddressesModel::rowsAboutToBeRemoved,
+    this, &TimelineModel::handleSourceRowsAboutToBeRemoved
+  );
+  QObject::connect(mSipAddressesModel, &SipAddressesModel::modelReset, this, &TimelineModel::handleSourceModelReset);
+
+  handleSourceModelReset();
+}
+
+int TimelineModel::rowCount (const QModelIndex &) const {
+  return mEntries.count();
 }
 
 QHash<int, QByteArray> TimelineModel::roleNames () const {
@@ -39,13 +54,155 @@ QHash<int, QByteArray> TimelineModel::roleNames () const {
   return roles;
 }
 
+QVariant TimelineModel::data (const QModelIndex &index, int role) const {
+  int row = index.row();
+
+  if (!index.isValid() || row < 0 || row >= mEntries.count())
+    return QVariant();
+
+  if (role == Qt::DisplayRole)
+    return mSipAddressesModel->find(mEntries[row].sipAddress);
+
+  return QVariant();
+}
+
 // -----------------------------------------------------------------------------
 
-bool TimelineModel::filterAcceptsRow (int sourceRow, const QModelIndex &sourceParent) const {
-  const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-  return index.data().toMap().contains("timestamp");
+bool TimelineModel::isBefore (const TimelineEntry &a, const TimelineEntry &b) {
+  return a.timestamp > b.timestamp || (a.timestamp == b.timestamp && a.sipAddress < b.sipAddress);
+}
+
+int TimelineModel::findRow (const TimelineEntry &entry) const {
+  auto it = lower_bound(mEntries.cbegin(), mEntries.cend(), entry, isBefore);
+  if (it == mEntries.cend() || it->sipAddress != entry.sipAddress)
+    return -1;
+
+  return static_cast<int>(distance(mEntries.cbegin(), it));
 }
 
-bool TimelineModel::lessThan (const QModelIndex &left, const QModelIndex &right) const {
-  return sourceModel()->data(left).toMap()["timestamp"] > sourceModel()->data(right).toMap()["timestamp"];
+// -----------------------------------------------------------------------------
+
+void TimelineModel::insertEntry (const TimelineEntry &entry) {
+  int row = static_cast<int>(
+    distance(mEntries.cbegin(), lower_bound(mEntries.cbegin(), mEntries.cend(), entry, isBefore))
+  );
+
+  beginInsertRows(QModelIndex(), row, row);
+  mEntries.insert(row, entry);
+  mTimestamps[entry.sipAddress] = entry.timestamp;
+  endInsertRows();
+}
+
+void TimelineModel::removeEntry (int row) {
+  beginRemoveRows(QModelIndex(), row, row);
+  mTimestamps.remove(mEntries[row].sipAddress);
+  mEntries.remove(row);
+  endRemoveRows();
+}
+
+void TimelineModel::updateEntry (int row, qint64 timestamp) {
+  TimelineEntry entry = mEntries[row];
+  entry.timestamp = timestamp;
+  mTimestamps[entry.sipAddress] = timestamp;
+
+  // The old entry is still in the list at this point, so the vector is sorted.
+  int destRow = static_cast<int>(
+    distance(mEntries.cbegin(), lower_bound(mEntries.cbegin(), mEntries.cend(), entry, isBefore))
+  );
+
+  // Same position, no move.
+  if (destRow == row || destRow == row + 1) {
+    mEntries[row] = entry;
+    emit dataChanged(index(row, 0), index(row, 0));
+    return;
+  }
+
+  beginMoveRows(QModelIndex(), row, row, QModelIndex(), destRow);
+
+  mEntries.remove(row);
+  if (destRow > row)
+    --destRow;
+  mEntries.insert(destRow, entry);
+
+  endMoveRows();
+
+  emit dataChanged(index(destRow, 0), index(destRow, 0));
+}
+
+// -----------------------------------------------------------------------------
+
+void TimelineModel::handleSourceDataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+  for (int sourceRow = topLeft.row(); sourceRow <= bottomRight.row(); ++sourceRow) {
+    const QModelIndex sourceIndex = mSipAddressesModel->index(sourceRow, 0);
+
+    const QString sipAddress = sourceIndex.data(SipAddressesModel::SipAddressRole).toString();
+    qint64 timestamp = sourceIndex.data(SipAddressesModel::TimestampRole).toLongLong();
+
+    auto it = mTimestamps.find(sipAddress);
+
+    // 1. New history.
+    if (it == mTimestamps.end()) {
+      if (timestamp)
+        insertEntry({ timestamp, sipAddress });
+      continue;
+    }
+
+    int row = findRow({ *it, sipAddress });
+    Q_ASSERT(row != -1);
+
+    // 2. History removed.
+    if (!timestamp)
+      removeEntry(row);
+    // 3. New activity.
+    else if (timestamp != *it)
+      updateEntry(row, timestamp);
+    // 4. Other changes. (Presence, contact...)
+    else
+      emit dataChanged(index(row, 0), index(row, 0));
+  }
+}
+
+void TimelineModel::handleSourceRowsInserted (const QModelIndex &, int first, int last) {
+  for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+    const QModelIndex sourceIndex = mSipAddressesModel->index(sourceRow, 0);
+
+    qint64 timestamp = sourceIndex.data(SipAddressesModel::TimestampRole).toLongLong();
+    if (timestamp)
+      insertEntry({ timestamp, sourceIndex.data(SipAddressesModel::SipAddressRole).toString() });
+  }
+}
+
+void TimelineModel::handleSourceRowsAboutToBeRemoved (const QModelIndex &, int first, int last) {
+  for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+    const QString sipAddress = mSipAddressesModel->index(sourceRow, 0).data(
+        SipAddressesModel::SipAddressRole
+      ).toString();
+
+    auto it = mTimestamps.find(sipAddress);
+    if (it != mTimestamps.end())
+      removeEntry(findRow({ *it, sipAddress }));
+  }
+}
+
+void TimelineModel::handleSourceModelReset () {
+  beginResetModel();
+
+  mEntries.clear();
+  mTimestamps.clear();
+
+  for (int sourceRow = 0, count = mSipAddressesModel->rowCount(); sourceRow < count; ++sourceRow) {
+    const QModelIndex sourceIndex = mSipAddressesModel->index(sourceRow, 0);
+
+    qint64 timestamp = sourceIndex.data(SipAddressesModel::TimestampRole).toLongLong();
+    if (!timestamp)
+      continue;
+
+    TimelineEntry entry = { timestamp, sourceIndex.data(SipAddressesModel::SipAddressRole).toString() };
+    mEntries << entry;
+    mTimestamps[entry.sipAddress] = timestamp;
+  }
+
+  sort(mEntries.begin(), mEntries.end(), isBefore);
+
+  endResetModel();
 }
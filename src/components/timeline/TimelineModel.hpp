@@ -23,22 +23,54 @@
 #ifndef TIMELINE_MODEL_H_
 #define TIMELINE_MODEL_H_
 
-#include <QSortFilterProxyModel>
+#include <QAbstractListModel>
+#include <QVector>
 
 // =============================================================================
+// Sip addresses with history, sorted by last activity.
+// The order is maintained incrementally: an update moves one row at most.
+// =============================================================================
+
+class SipAddressesModel;
 
-class TimelineModel : public QSortFilterProxyModel {
+class TimelineModel : public QAbstractListModel {
   Q_OBJECT;
 
 public:
   TimelineModel (QObject *parent = Q_NULLPTR);
   ~TimelineModel () = default;
 
+  int rowCount (const QModelIndex &index = QModelIndex()) const override;
+
   QHash<int, QByteArray> roleNames () const override;
+  QVariant data (const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+  struct TimelineEntry {
+    qint64 timestamp;
+    QString sipAddress;
+  };
+
+  static bool isBefore (const TimelineEntry &a, const TimelineEntry &b);
+
+  int findRow (const TimelineEntry &entry) const;
+
+  void insertEntry (const TimelineEntry &entry);
+  void removeEntry (int row);
+  void updateEntry (int row, qint64 timestamp);
+
+  void handleSourceDataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight);
+  void handleSourceRowsInserted (const QModelIndex &parent, int first, int last);
+  void handleSourceRowsAboutToBeRemoved (const QModelIndex &parent, int first, int last);
+  void handleSourceModelReset ();
+
+  SipAddressesModel *mSipAddressesModel;
+
+  // Sorted by descending timestamp.
+  QVector<TimelineEntry> mEntries;
 
-protected:
-  bool filterAcceptsRow (int sourceRow, const QModelIndex &sourceParent) const override;
-  bool lessThan (const QModelIndex &left, const QModelIndex &right) const override;
+  // Current timestamp of each entry, used to find its row.
+  QHash<QString, qint64> mTimestamps;
 };
 
 #endif // TIMELINE_MODEL_H_
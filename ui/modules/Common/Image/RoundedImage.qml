@@ -1,4 +1,5 @@
 import QtQuick 2.7
+import QtQuick.Window 2.2
 
 // =============================================================================
 
@@ -22,6 +23,10 @@ Item {
 
       anchors.fill: parent
       fillMode: Image.PreserveAspectCrop
+
+      // Decoded at the displayed size, not at the size of the file.
+      sourceSize.width: width * Screen.devicePixelRatio
+      sourceSize.height: height * Screen.devicePixelRatio
     }
   }
 
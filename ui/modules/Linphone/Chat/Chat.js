@@ -15,16 +15,16 @@ function loadMoreEntries () {
   }
 }
 
-function getComponentFromEntry (chatEntry) {
-  if (chatEntry.fileName) {
+function getComponentFromEntry (type, isOutgoing, fileName) {
+  if (fileName) {
     return 'FileMessage.qml'
   }
 
-  if (chatEntry.type === ChatModel.CallEntry) {
+  if (type === ChatModel.CallEntry) {
     return 'Event.qml'
   }
 
-  return chatEntry.isOutgoing ? 'OutgoingMessage.qml' : 'IncomingMessage.qml'
+  return isOutgoing ? 'OutgoingMessage.qml' : 'IncomingMessage.qml'
 }
 
 function handleFilesDropped (files) {
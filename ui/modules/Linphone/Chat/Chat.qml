@@ -165,7 +165,7 @@ Rectangle {
               color: ChatStyle.entry.time.color
               font.pointSize: ChatStyle.entry.time.pointSize
 
-              text: $chatEntry.timestamp.toLocaleString(
+              text: $timestamp.toLocaleString(
                 Qt.locale(App.locale),
                 'hh:mm'
               )
@@ -173,14 +173,14 @@ Rectangle {
               verticalAlignment: Text.AlignVCenter
 
               TooltipArea {
-                text: $chatEntry.timestamp.toLocaleString(Qt.locale(App.locale))
+                text: $timestamp.toLocaleString(Qt.locale(App.locale))
               }
             }
 
             // Display content.
             Loader {
               Layout.fillWidth: true
-              source: Logic.getComponentFromEntry($chatEntry)
+              source: Logic.getComponentFromEntry($type, $isOutgoing, $fileName)
             }
           }
         }
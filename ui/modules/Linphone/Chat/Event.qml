@@ -9,19 +9,19 @@ import Utils 1.0
 
 Row {
   property string _type: {
-    var status = $chatEntry.status
+    var status = $status
 
     if (status === ChatModel.CallStatusSuccess) {
-      if (!$chatEntry.isStart) {
+      if (!$isStart) {
         return 'ended_call'
       }
-      return $chatEntry.isOutgoing ? 'outgoing_call' : 'incoming_call'
+      return $isOutgoing ? 'outgoing_call' : 'incoming_call'
     }
     if (status === ChatModel.CallStatusDeclined) {
-      return $chatEntry.isOutgoing ? 'declined_outgoing_call' : 'declined_incoming_call'
+      return $isOutgoing ? 'declined_outgoing_call' : 'declined_incoming_call'
     }
     if (status === ChatModel.CallStatusMissed) {
-      return $chatEntry.isOutgoing ? 'missed_outgoing_call' : 'missed_incoming_call'
+      return $isOutgoing ? 'missed_outgoing_call' : 'missed_incoming_call'
     }
 
     return 'unknown_call_event'
@@ -33,7 +33,7 @@ Row {
 
     Loader {
       anchors.centerIn: parent
-      sourceComponent: !$chatEntry.isOutgoing ? avatar : undefined
+      sourceComponent: !$isOutgoing ? avatar : undefined
     }
   }
 
@@ -52,11 +52,11 @@ Row {
         ChatModel.MessageStatusIdle,
         ChatModel.MessageStatusInProgress,
         ChatModel.MessageStatusNotDelivered
-      ], $chatEntry.status)
+      ], $status)
 
-      readonly property bool isRead: $chatEntry.status === ChatModel.MessageStatusDisplayed
+      readonly property bool isRead: $status === ChatModel.MessageStatusDisplayed
 
-      color: $chatEntry.isOutgoing
+      color: $isOutgoing
         ? ChatStyle.entry.message.outgoing.backgroundColor
         : ChatStyle.entry.message.incoming.backgroundColor
 
@@ -81,7 +81,7 @@ Row {
           id: thumbnail
 
           Image {
-            source: $chatEntry.thumbnail
+            source: $thumbnail
           }
         }
 
@@ -97,7 +97,7 @@ Row {
               color: ChatStyle.entry.message.file.extension.text.color
               font.bold: true
               elide: Text.ElideRight
-              text: Utils.getExtension($chatEntry.fileName).toUpperCase()
+              text: Utils.getExtension($fileName).toUpperCase()
 
               horizontalAlignment: Text.AlignHCenter
               verticalAlignment: Text.AlignVCenter
@@ -111,7 +111,7 @@ Row {
           Layout.fillHeight: true
           Layout.preferredWidth: parent.height
 
-          sourceComponent: $chatEntry.thumbnail ? thumbnail : extension
+          sourceComponent: $thumbnail ? thumbnail : extension
 
           ScaleAnimator {
             id: thumbnailProviderAnimator
@@ -176,19 +176,19 @@ Row {
           Text {
             id: fileName
 
-            color: $chatEntry.isOutgoing
+            color: $isOutgoing
               ? ChatStyle.entry.message.outgoing.text.color
               : ChatStyle.entry.message.incoming.text.color
             elide: Text.ElideRight
 
             font {
               bold: true
-              pointSize: $chatEntry.isOutgoing
+              pointSize: $isOutgoing
                 ? ChatStyle.entry.message.outgoing.text.pointSize
                 : ChatStyle.entry.message.incoming.text.pointSize
             }
 
-            text: $chatEntry.fileName
+            text: $fileName
             width: parent.width
           }
 
@@ -198,9 +198,9 @@ Row {
             height: ChatStyle.entry.message.file.status.bar.height
             width: parent.width
 
-            to: $chatEntry.fileSize
-            value: $chatEntry.fileOffset || 0
-            visible: $chatEntry.status === ChatModel.MessageStatusInProgress
+            to: $fileSize
+            value: $fileOffset || 0
+            visible: $status === ChatModel.MessageStatusInProgress
 
             background: Rectangle {
               color: ChatStyle.entry.message.file.status.bar.background.color
@@ -221,10 +221,19 @@ Row {
             elide: Text.ElideRight
             font.pointSize: fileName.font.pointSize
             text: {
-              var fileSize = Utils.formatSize($chatEntry.fileSize)
-              return progressBar.visible
-                ? Utils.formatSize($chatEntry.fileOffset) + '/' + fileSize
-                : fileSize
+              var fileSize = Utils.formatSize($fileSize)
+              if (!progressBar.visible) {
+                return fileSize
+              }
+
+              var text = Utils.formatSize($fileOffset) + '/' + fileSize
+              if ($fileSpeed > 0) {
+                text += ' - ' + Utils.formatSize($fileSpeed) + '/s'
+              }
+              if ($fileRemainingTime >= 0) {
+                text += ' - ' + Utils.formatElapsedTime($fileRemainingTime)
+              }
+              return text
             }
           }
         }
@@ -240,7 +249,7 @@ Row {
 
         icon: 'download'
         iconSize: ChatStyle.entry.message.file.iconSize
-        visible: !$chatEntry.isOutgoing && !$chatEntry.wasDownloaded
+        visible: !$isOutgoing && !$wasDownloaded
       }
 
       MouseArea {
@@ -255,12 +264,12 @@ Row {
           ? Qt.PointingHandCursor
           : Qt.ArrowCursor
         hoverEnabled: true
-        visible: !rectangle.isNotDelivered && !$chatEntry.isOutgoing
+        visible: !rectangle.isNotDelivered && !$isOutgoing
 
         onClicked: {
           if (Utils.pointIsInItem(this, thumbnailProvider, mouse)) {
             proxyModel.openFile(index)
-          } else if ($chatEntry.wasDownloaded) {
+          } else if ($wasDownloaded) {
             proxyModel.openFileDirectory(index)
           } else  {
             proxyModel.downloadFile(index)
@@ -306,9 +315,9 @@ Row {
         height: ChatStyle.entry.lineHeight
         width: ChatStyle.entry.message.outgoing.sendIconSize
 
-        sourceComponent: $chatEntry.isOutgoing
+        sourceComponent: $isOutgoing
           ? (
-            $chatEntry.status === ChatModel.MessageStatusInProgress
+            $status === ChatModel.MessageStatusInProgress
               ? indicator
               : icon
           ) : undefined
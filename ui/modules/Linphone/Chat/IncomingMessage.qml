@@ -30,17 +30,18 @@ RowLayout {
           return true // 1. First message, so visible.
         }
 
-        var previousEntry = proxyModel.data(proxyModel.index(index - 1, 0))
-        if (!previousEntry) {
+        var previousIndex = proxyModel.index(index - 1, 0)
+        var previousType = proxyModel.data(previousIndex, ChatModel.TypeRole)
+        if (previousType === undefined) {
           return true
         }
 
         // 2. Previous entry is a call event. => Visible.
         // 3. I have sent a message before my contact. => Visible.
         // 4. One hour between two incoming messages. => Visible.
-        return previousEntry.type !== ChatModel.MessageEntry ||
-          previousEntry.isOutgoing ||
-          $chatEntry.timestamp.getTime() - previousEntry.timestamp.getTime() > 3600
+        return previousType !== ChatModel.MessageEntry ||
+          proxyModel.data(previousIndex, ChatModel.IsOutgoingRole) ||
+          $timestamp.getTime() - proxyModel.data(previousIndex, ChatModel.TimestampRole).getTime() > 3600
       }
     }
   }
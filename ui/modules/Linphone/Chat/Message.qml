@@ -53,7 +53,7 @@ Item {
     padding: ChatStyle.entry.message.padding
     readOnly: true
     selectByMouse: true
-    text: Utils.encodeTextToQmlRichFormat($chatEntry.content, {
+    text: Utils.encodeTextToQmlRichFormat($content, {
       imagesHeight: ChatStyle.entry.message.images.height,
       imagesWidth: ChatStyle.entry.message.images.width
     })
@@ -73,14 +73,14 @@ Item {
 
       MenuItem {
         text: qsTr('menuCopy')
-        onTriggered: Clipboard.text = $chatEntry.content
+        onTriggered: Clipboard.text = $content
       }
 
       MenuItem {
         enabled: TextToSpeech.available
         text: qsTr('menuPlayMe')
 
-        onTriggered: TextToSpeech.say($chatEntry.content)
+        onTriggered: TextToSpeech.say($content)
       }
     }
 